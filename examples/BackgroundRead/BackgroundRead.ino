@@ -30,9 +30,11 @@
  * up to measure using the maximum conversion length (and maximum accuracy) and then average those
  * readings 64 times. This results in readings taking 8.244ms x 64 = 527.616ms or just less than 2
  * times a second. The pin-change interrupt handler is called when a reading is finished and the
- * INA226 pulls the pin down to ground, it resets the pin status and adds the readings to the global
- * variables. The main program will do whatever processing it has to and every 5 seconds it will
- * display the current averaged readings and reset them.\n
+ * INA226 pulls the pin down to ground. The handler only tells the library that a conversion has
+ * finished, the I2C reads are done by "serviceSamples()" in the main loop, which stores the raw
+ * readings in the library's sample buffer. The main program will do whatever processing it has to,
+ * takes the samples from the buffer, and every 10 readings it will display the current averaged
+ * readings and reset them.\n
  *
  * The datasheet for the INA226 can be found at http://www.ti.com/lit/ds/symlink/INA226.pdf and it
  * contains the information required in order to hook up the device. Unfortunately it comes as a
@@ -63,6 +65,7 @@
  *
  * Version | Date       | Developer   | Comments
  * ------- | ---------- | ----------- | ------------------------------------------------------------
+ * 1.0.6   | 2026-10-18 | mohamadxmuhaimin | No I2C calls in the ISR, use the library sample buffer
  * 1.0.5   | 2020-12-01 | SV-Zanshin  | Corrected "alertOnConversion()" call
  * 1.0.4   | 2019-02-16 | SV-Zanshin  | ifdef so that sketch won't compile on incompatible platforms
  * 1.0.3   | 2019-01-09 | SV-Zanshin  | Cleaned up doxygen formatting
@@ -90,30 +93,19 @@ const uint32_t SERIAL_SPEED  = 115200;  ///< Use fast serial speed
 /**************************************************************************************************
 ** Declare global variables and instantiate classes                                              **
 **************************************************************************************************/
-INA_Class         INA;                          ///< INA class instantiation
-volatile uint8_t  deviceNumber    = UINT8_MAX;  ///< Device Number to use in example
-volatile uint64_t sumBusMillVolts = 0;          ///< Sum of bus voltage readings
-volatile int64_t  sumBusMicroAmps = 0;          ///< Sum of bus amperage readings
-volatile uint8_t  readings        = 0;          ///< Number of measurements taken
+INA_Class        INA;                          ///< INA class instantiation
+volatile uint8_t deviceNumber    = UINT8_MAX;  ///< Device Number to use in example
+uint64_t         sumBusMillVolts = 0;          ///< Sum of bus voltage readings
+int64_t          sumBusMicroAmps = 0;          ///< Sum of bus amperage readings
+uint8_t          readings        = 0;          ///< Number of measurements taken
 
 ISR(PCINT0_vect) {
   /*!
     @brief Interrupt service routine for the PCINT0_vect
-    @details Routine is called whenever the INA_ALERT_PIN changes value
+    @details Routine is called whenever the INA_ALERT_PIN changes value. It only flags the device,
+             the I2C reads are done outside of the interrupt by "serviceSamples()"
   */
-  *digitalPinToPCMSK(INA_ALERT_PIN) &= ~bit(digitalPinToPCMSKbit(INA_ALERT_PIN));  // Disable PCMSK
-  PCICR &= ~bit(digitalPinToPCICRbit(INA_ALERT_PIN));        // disable interrupt for the group
-  sei();                                                     // Enable interrupts (for I2C calls)
-  digitalWrite(GREEN_LED_PIN, !digitalRead(GREEN_LED_PIN));  // Toggle LED
-  sumBusMillVolts += INA.getBusMilliVolts(deviceNumber);     // Add current value to sum
-  sumBusMicroAmps += INA.getBusMicroAmps(deviceNumber);      // Add current value to sum
-  readings++;
-  INA.waitForConversion(deviceNumber);  // Wait for conversion & INA int. flag
-  cli();                                // Disable interrupts
-  *digitalPinToPCMSK(INA_ALERT_PIN) |=
-      bit(digitalPinToPCMSKbit(INA_ALERT_PIN));       // Enable PCMSK pin
-  PCIFR |= bit(digitalPinToPCICRbit(INA_ALERT_PIN));  // clear any outstanding interrupt
-  PCICR |= bit(digitalPinToPCICRbit(INA_ALERT_PIN));  // enable interrupt for the group
+  if (!digitalRead(INA_ALERT_PIN)) INA.flagConversion(deviceNumber);  // Pin low, reading ready
 }  // of ISR handler for INT0 group of pins
 
 /*!
@@ -134,7 +126,7 @@ void setup() {
 #ifdef __AVR_ATmega32U4__  // If this is a 32U4 processor, wait 2 seconds for initialization
   delay(2000);
 #endif
-  Serial.print(F("\n\nBackground INA Read V1.0.5\n"));
+  Serial.print(F("\n\nBackground INA Read V1.0.6\n"));
   uint8_t devicesFound = 0;
   while (deviceNumber == UINT8_MAX)  // Loop until we find the first device
   {
@@ -161,19 +153,30 @@ void setup() {
   INA.setShuntConversion(8244, deviceNumber);           // Maximum conversion time 8.244ms
   INA.setMode(INA_MODE_CONTINUOUS_BOTH, deviceNumber);  // Bus/shunt measured continuously
   INA.alertOnConversion(true, deviceNumber);            // Make alert pin go low on finish
+  INA.beginSampling();                                  // Buffer for the background samples
 }  // of method setup()
 
 void loop() {
   /*!
    @brief    Arduino method for the main program loop
    @details  This is the main program for the Arduino IDE, it is called in an infinite loop. The
-             INA226 measurements are triggered by the interrupt handler each time a conversion is
-             ready and stored in variables. The main program doesn't call any INA library functions,
-             that is done in the interrupt handler. Each time 10 readings have been collected the
-             program will output the averaged values and measurements resume from that point onwards
+             interrupt handler flags the INA226 each time a conversion is ready, "serviceSamples()"
+             reads the flagged device into the sample buffer and the samples are then added to the
+             sums. Each time 10 readings have been collected the program will output the averaged
+             values and measurements resume from that point onwards
    @return   void
   */
   static long lastMillis = millis();  // Store the last time we printed something
+  inaSample   sample;                 // Raw sample from the buffer
+  inaReading  reading;                // Converted values of the sample
+  INA.serviceSamples();               // Read the devices flagged by the ISR
+  while (INA.readSample(sample)) {
+    digitalWrite(GREEN_LED_PIN, !digitalRead(GREEN_LED_PIN));  // Toggle LED
+    INA.convertSample(sample, reading);
+    sumBusMillVolts += reading.busMilliVolts;  // Add current value to sum
+    sumBusMicroAmps += reading.busMicroAmps;   // Add current value to sum
+    readings++;
+  }  // of while there are samples in the buffer
   if (readings >= 10) {
     Serial.print(F("Averaging readings taken over "));
     Serial.print((float)(millis() - lastMillis) / 1000, 2);
@@ -182,11 +185,9 @@ void loop() {
     Serial.print(F("V\nBus amperage:  "));
     Serial.print((float)sumBusMicroAmps / readings / 1000.0, 4);
     Serial.print(F("mA\n\n"));
-    lastMillis = millis();
-    cli();  // Disable interrupts to reset values
+    lastMillis      = millis();
     readings        = 0;
     sumBusMillVolts = 0;
     sumBusMicroAmps = 0;
-    sei();  // Enable interrupts again
-  }         // of if-then we've reached the required amount of readings
+  }  // of if-then we've reached the required amount of readings
 }  // of method loop()
@@ -0,0 +1,127 @@
+/*!
+ *
+ * @file SamplingTask_ESP32.ino
+ *
+ * @brief Example program for the INA Library demonstrating the ESP32 sampling task
+ *
+ * @section SamplingTask_ESP32_section Description
+ *
+ * Program to demonstrate reading all INA2xx devices from a FreeRTOS task pinned to core 0. The
+ * task started with "startSamplingTask()" owns the I2C bus and reads every device found 10 times a
+ * second. Each set of readings is published as a frame, and "loop()" (which runs on core 1) takes
+ * the latest complete frame with "latestFrame()" without blocking and without any I2C traffic of
+ * its own. The sampling rate therefore stays steady regardless of what the application core or
+ * the WiFi stack are doing.\n\n
+ *
+ * This example program is designed for the ESP32 and will not function on other platforms\n\n
+ *
+ * Detailed documentation can be found on the GitHub Wiki pages at
+ * https://github.com/Zanduino/INA/wiki \n\n
+ *
+ * This example is for INA devices set up to measure a 5-Volt load with a 0.1Ohm resistor in place,
+ * this is the same setup that can be found in the Adafruit INA219 breakout board. Each device is
+ * set to continuous mode, so the task reads the latest conversion results, and once a second the
+ * last frame is displayed together with the number of frames taken since the previous display.\n
+ *
+ * @section SamplingTask_ESP32_license GNU General Public License v3.0
+ *
+ * This program is free software : you can redistribute it and/or modify it under the terms of the
+ * GNU General Public License as published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.This program is distributed in the hope that it
+ * will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for more details.You should
+ * have received a copy of the GNU General Public License along with this program(see
+ * https://github.com/Zanduino/INA/blob/master/LICENSE).  If not, see
+ * <http://www.gnu.org/licenses/>.
+ *
+ * @section SamplingTask_ESP32_author Author
+ *
+ * Written by mohamadxmuhaimin
+ *
+ * @section SamplingTask_ESP32_versions Changelog
+ *
+ * Version | Date       | Developer        | Comments
+ * ------- | ---------- | ---------------- | --------
+ * 1.0.0   | 2026-10-18 | mohamadxmuhaimin | Cloned and adapted from "BackgroundRead_ESP32.ino"
+ *
+ */
+#if !defined(ESP32)
+  #error Example program only functions on the ESP32 platform
+#endif
+
+/**************************************************************************************************
+** Declare all include files                                                                     **
+**************************************************************************************************/
+#include <INA.h>  // Include the INA library
+
+/**************************************************************************************************
+** Declare program Constants, global variables and instantiate classes                           **
+**************************************************************************************************/
+const uint32_t SERIAL_SPEED  = 115200;  ///< Use fast serial speed
+const uint16_t SAMPLE_MILLIS = 100;     ///< Time between the starts of 2 frames
+const uint8_t  MAX_DEVICES   = 8;       ///< Number of devices displayed
+INA_Class      INA;                     ///< INA class instantiation
+uint8_t        devicesFound  = 0;       ///< Number of INA devices found on the I2C bus
+uint32_t       lastFrame     = 0;       ///< Number of the frame displayed last
+inaReading     frame[MAX_DEVICES];      ///< Copy of the latest frame
+
+void setup() {
+  /*!
+   @brief    Arduino method called once at startup to initialize the system
+   @details  This is an Arduino IDE method which is called first upon boot or restart. It is only
+             called one time and then control goes to the main "loop()" method, from which control
+             never returns. All settings are made before the sampling task is started, as the task
+             is the only user of the library from then on
+   @return   void
+  */
+  Serial.begin(SERIAL_SPEED);
+  Serial.print(F("\n\nINA Sampling Task V1.0.0\n"));
+  devicesFound = INA.begin(1, 100000);  // +/- 1 Amps maximum for 0.1 Ohm resistor
+  while (devicesFound == 0) {
+    Serial.print(F("No INA found. Waiting 5s and retrying...\n"));
+    delay(5000);
+    devicesFound = INA.begin(1, 100000);
+  }  // of while no device found
+  Serial.print(F("Found "));
+  Serial.print(devicesFound);
+  Serial.print(F(" INA devices\n\n"));
+  INA.configure()                         // One configuration register write per device
+      .averaging(16)                      // Average each reading 16 times
+      .busConv(1100)                      // 1.1ms conversions, 16 x 2 x 1.1ms is below 100ms
+      .shuntConv(1100)                    // for the devices measuring both
+      .mode(INA_MODE_CONTINUOUS_BOTH)     // Bus/shunt measured continuously
+      .apply();
+  if (!INA.startSamplingTask(SAMPLE_MILLIS)) {
+    Serial.print(F("Unable to start the sampling task\n"));
+  }  // of if-then task not started
+}  // of method setup()
+
+void loop() {
+  /*!
+   @brief    Arduino method for the main program loop
+   @details  This is the main program for the Arduino IDE, it is called in an infinite loop. Once a
+             second the latest frame is copied from the sampling task and displayed, the copy
+             takes a few microseconds and never waits for the task
+   @return   void
+  */
+  static uint32_t lastMillis = millis();  // Store the last time we printed something
+  if (millis() - lastMillis < 1000) return;
+  lastMillis = millis();
+  uint32_t timestamp;
+  uint32_t frameNumber = INA.latestFrame(frame, MAX_DEVICES, timestamp);
+  Serial.print(F("Frame "));
+  Serial.print(frameNumber);
+  Serial.print(F(", "));
+  Serial.print(frameNumber - lastFrame);
+  Serial.print(F(" frames in the last second\n"));
+  lastFrame = frameNumber;
+  for (uint8_t i = 0; i < devicesFound && i < MAX_DEVICES; i++) {
+    Serial.print(i);
+    Serial.print(F(": "));
+    Serial.print((float)frame[i].busMilliVolts / 1000.0, 4);
+    Serial.print(F("V "));
+    Serial.print((float)frame[i].busMicroAmps / 1000.0, 4);
+    Serial.print(F("mA\n"));
+  }  // for-next each device
+  Serial.print(F("\n"));
+}  // of method loop()
@@ -0,0 +1,42 @@
+/*!
+ * @file Arduino.h
+ *
+ * @brief Minimal host-side stand-in for the Arduino core header
+ *
+ * @section Arduino_host_intro_section Description
+ *
+ * Only the subset of the Arduino core used by the INA library is declared here. Time is not taken
+ * from the host clock but from the simulated clock in "INASim.h", so "micros()" moves forward
+ * only when I2C traffic is simulated or when the library calls "delayMicroseconds()". This keeps
+ * every benchmark run deterministic and independent of the speed of the host machine.
+ *
+ */
+#ifndef INA_HOST_ARDUINO_H
+/*! Guard code definition to prevent multiple includes */
+#define INA_HOST_ARDUINO_H
+#include <stddef.h>  // size_t
+#include <stdint.h>  // fixed-width integer types and UINT8_MAX
+#include <string.h>  // memcpy and strcmp
+
+#define B111      7  ///< Binary literal used by the library
+#define B00000111 7  ///< Binary literal used by the library
+
+#define bitRead(value, bit)  (((value) >> (bit)) & 0x01)       ///< Read a single bit
+#define bitSet(value, bit)   ((value) |= (1UL << (bit)))       ///< Set a single bit
+#define bitClear(value, bit) ((value) &= ~(1UL << (bit)))      ///< Clear a single bit
+#define bitWrite(value, bit, bitvalue) \
+  ((bitvalue) ? bitSet(value, bit) : bitClear(value, bit))   ///< Write a single bit
+#define F(string_literal)    (string_literal)                  ///< No PROGMEM on the host
+#define IRAM_ATTR                                              ///< No IRAM on the host
+#define noInterrupts()                                         ///< No interrupts on the host
+#define interrupts()                                           ///< No interrupts on the host
+#define cli()                                                  ///< No interrupts on the host
+#define SREG                 hostStatusRegister                ///< AVR status register stand-in
+
+uint32_t micros();                            ///< Simulated microseconds since start
+uint32_t millis();                            ///< Simulated milliseconds since start
+void     delayMicroseconds(uint32_t micros);  ///< Advance the simulated clock
+void     delay(uint32_t millis);              ///< Advance the simulated clock
+void     yield();                             ///< Does nothing on the host
+extern uint8_t hostStatusRegister;            ///< Only saved and restored by the library
+#endif
@@ -0,0 +1,188 @@
+/*!
+ * @file Benchmark.cpp
+ *
+ * @brief Host-side benchmark of the INA library against simulated devices
+ *
+ * @section Benchmark_intro_section Description
+ *
+ * One device of each supported type is attached to the simulated bus and "begin()" is called just
+ * as a sketch would. Each public getter is then called repeatedly at every standard I2C clock
+ * rate, once reading the same device over and over and once cycling through all devices, and the
+ * cost per call is reported as:\n
+ * - I2C transactions (START conditions) and data bytes\n
+ * - simulated bus time and total simulated time (bus time plus the library's delays)\n
+ * - EEPROM.get() calls\n
+ * - host CPU time, which is only meaningful for comparing two builds on the same machine\n\n
+ * A second INA226, which "begin()" doesn't see, is read through the compile-time "INA_Device"
+ * template for comparison with the same calls on the first one.\n\n
+ * Usage: ina_benchmark [iterations] [cache] [calibrate]\n
+ * The iterations default to 1000 and must be given before the options, as a number of at least 1.
+ * With "cache" the INA_Class instance is constructed with the descriptor cache enabled, with
+ * "calibrate" the I2C settle delay is calibrated with "calibrateI2CDelay()" at each clock rate.
+ * The simulated devices then only follow a pointer write after "kSettleNanos", so that the
+ * calibration has something to find
+ *
+ */
+#include <EEPROM.h>
+#include <INA.h>
+#include <INADevice.h>
+#include <Wire.h>
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+#include "INASim.h"
+
+/*! Description of one measured library call */
+struct Operation {
+  const char* name;                                   ///< Name printed in the report
+  int64_t (*call)(INA_Class& ina, const uint8_t dev);  ///< Call to measure
+  bool        singleOnly;                             ///< Only one device, skip round-robin
+};
+
+static INA_Device<INA226, 0x4F, 4, 20000> fixed226;  ///< Compile-time INA226, 4A, 20mOhm shunt
+
+/*! Wrap a getter as an "Operation" entry */
+#define INA_OPERATION(getter) \
+  { #getter, [](INA_Class& ina, const uint8_t d) -> int64_t { return ina.getter(d); }, false }
+static const Operation kOperations[] = {
+    INA_OPERATION(getBusMilliVolts), INA_OPERATION(getShuntMicroVolts),
+    INA_OPERATION(getBusMicroAmps),  INA_OPERATION(getBusMicroWatts),
+    INA_OPERATION(getBusRaw),        INA_OPERATION(getShuntRaw),
+    INA_OPERATION(conversionFinished),
+    {"readAll", [](INA_Class& ina, const uint8_t d) -> int64_t {
+       inaReading reading;
+       ina.readAll(d, reading);
+       return reading.busMicroWatts;
+     }, false},
+    {"INA_Device amps", [](INA_Class&, const uint8_t) -> int64_t {
+       return fixed226.getBusMicroAmps();
+     }, true},
+    {"INA_Device readAll", [](INA_Class&, const uint8_t) -> int64_t {
+       inaReading reading;
+       fixed226.readAll(reading);
+       return reading.busMicroWatts;
+     }, true}};
+static const uint32_t kClocks[] = {INA_I2C_STANDARD_MODE, INA_I2C_FAST_MODE, INA_I2C_FAST_MODE_PLUS,
+                                   INA_I2C_HIGH_SPEED_MODE};
+
+static const uint32_t kSettleNanos = 3500;  ///< Pointer settle time simulated with "calibrate"
+
+static SimDevice ina219(SIM_INA219, 0x40);    ///< 12V, 1A over a 20mOhm shunt
+static SimDevice ina226(SIM_INA226, 0x41);    ///< 24V, 2A over a 20mOhm shunt
+static SimDevice ina228(SIM_INA228, 0x42);    ///< 48V, 1.5A over a 20mOhm shunt
+static SimDevice ina230(SIM_INA230, 0x43);    ///< 5V, 0.5A over a 20mOhm shunt
+static SimDevice ina231(SIM_INA231, 0x44);    ///< 3.3V, -0.25A over a 20mOhm shunt
+static SimDevice ina260(SIM_INA260, 0x45);    ///< 12V, 3A over the internal 2mOhm shunt
+static SimDevice ina3221(SIM_INA3221, 0x46);  ///< 5V/3.3V/12V rails over 20mOhm shunts
+static SimDevice ina226b(SIM_INA226, 0x4F);   ///< As "ina226", attached after "begin()"
+
+static void setupDevices() {
+  /*! @brief Attach the devices to the default bus and set their physical inputs */
+  ina219.busMicroVolts[0]   = 12000000;
+  ina219.shuntNanoVolts[0]  = 20000000;
+  ina226.busMicroVolts[0]   = 24000000;
+  ina226.shuntNanoVolts[0]  = 40000000;
+  ina228.busMicroVolts[0]   = 48000000;
+  ina228.shuntNanoVolts[0]  = 30000000;
+  ina230.busMicroVolts[0]   = 5000000;
+  ina230.shuntNanoVolts[0]  = 10000000;
+  ina231.busMicroVolts[0]   = 3300000;
+  ina231.shuntNanoVolts[0]  = -5000000;
+  ina260.busMicroVolts[0]   = 12000000;
+  ina260.shuntNanoVolts[0]  = 6000000;
+  ina3221.busMicroVolts[0]  = 5000000;
+  ina3221.shuntNanoVolts[0] = 10000000;
+  ina3221.busMicroVolts[1]  = 3300000;
+  ina3221.shuntNanoVolts[1] = 5000000;
+  ina3221.busMicroVolts[2]  = 12000000;
+  ina3221.shuntNanoVolts[2] = -2000000;
+  ina226b.busMicroVolts[0]  = 24000000;
+  ina226b.shuntNanoVolts[0] = 40000000;
+  SimDevice* devices[]      = {&ina219, &ina226, &ina228, &ina230, &ina231, &ina260, &ina3221};
+  for (SimDevice* device : devices) { SimDefaultBus.attach(device); }
+}  // of function setupDevices()
+
+static void measure(INA_Class& ina, const uint8_t devices, const Operation& op,
+                    const bool roundRobin, const uint32_t iterations) {
+  /*! @brief Call one operation "iterations" times and print the per-call cost */
+  SimDefaultBus.resetStats();
+  EEPROM.resetStats();
+  volatile int64_t sink      = 0;
+  const uint64_t   simStart  = simNanos();
+  const auto       hostStart = std::chrono::steady_clock::now();
+  uint32_t         calls     = 0;
+  for (uint32_t i = 0; i < iterations; ++i) {
+    if (roundRobin) {
+      for (uint8_t d = 0; d < devices; ++d, ++calls) { sink = sink + op.call(ina, d); }
+    } else {
+      sink = sink + op.call(ina, 1);  // Always the INA226
+      ++calls;
+    }  // of if-then-else round-robin
+  }    // for-next each iteration
+  const auto hostNanos = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                             std::chrono::steady_clock::now() - hostStart)
+                             .count();
+  const SimBusStats& s = SimDefaultBus.stats;
+  printf("  %-19s %-6s %7.2f %7.2f %9.1f %9.1f %7.2f %9.1f\n", op.name,
+         roundRobin ? "all" : "single", (double)s.transactions / calls,
+         (double)(s.bytesWritten + s.bytesRead) / calls,
+         (double)s.busNanos / 1000 / calls, (double)(simNanos() - simStart) / 1000 / calls,
+         (double)EEPROM.gets / calls, (double)hostNanos / calls);
+}  // of function measure()
+
+int main(int argc, char* argv[]) {
+  uint32_t iterations = 1000;
+  if (argc > 1) {
+    char*               end   = nullptr;
+    const unsigned long count = strtoul(argv[1], &end, 10);
+    if (end == argv[1] || *end != '\0' || argv[1][0] == '-' || count == 0 || count > UINT32_MAX) {
+      fprintf(stderr, "Usage: %s [iterations] [cache] [calibrate]\n"
+                      "iterations must be a number of at least 1, not \"%s\"\n",
+              argv[0], argv[1]);
+      return 2;
+    }  // if-then not a valid number
+    iterations = (uint32_t)count;
+  }  // if-then iterations given
+  bool cache = false, calibrate = false;
+  for (int i = 2; i < argc; ++i) {
+    cache     = cache || strcmp(argv[i], "cache") == 0;
+    calibrate = calibrate || strcmp(argv[i], "calibrate") == 0;
+  }  // for-next each option
+  setupDevices();
+  if (calibrate) {
+    SimDevice* devices[] = {&ina219, &ina226,  &ina228, &ina230,
+                            &ina231, &ina260, &ina3221, &ina226b};
+    for (SimDevice* device : devices) { device->settleNanos = kSettleNanos; }
+  }  // if-then simulate a settle time
+  INA_Class ina(0, cache);
+  SimDefaultBus.resetStats();
+  const uint8_t      devices = ina.begin(4, 20000);  // 4A maximum, 20mOhm shunts
+  const SimBusStats& s       = SimDefaultBus.stats;
+  SimDefaultBus.attach(&ina226b);  // Only used through "fixed226"
+  fixed226.begin();
+  printf("begin(): %u devices, %u transactions, %u bytes, %.1f us bus time\n\n", devices,
+         s.transactions, s.bytesWritten + s.bytesRead, s.busNanos / 1000.0);
+  printf("  #  Device   Addr       mV          uV          uA          uW\n");
+  for (uint8_t d = 0; d < devices; ++d) {
+    printf("  %-2u %-8s 0x%02X %8u %11d %11d %11lld\n", d, ina.getDeviceName(d),
+           ina.getDeviceAddress(d), ina.getBusMilliVolts(d), ina.getShuntMicroVolts(d),
+           ina.getBusMicroAmps(d),
+           (long long)ina.getBusMicroWatts(d));
+  }  // for-next each device
+  for (const uint32_t clock : kClocks) {
+    ina.setI2CSpeed(clock);
+    printf("\nI2C clock %u Hz, %u iterations", clock, iterations);
+    if (calibrate) printf(", settle delay %u us", ina.calibrateI2CDelay());
+    printf("\n");
+    printf("  %-19s %-6s %7s %7s %9s %9s %7s %9s\n", "call", "device", "trans", "bytes", "bus us",
+           "sim us", "EE get", "host ns");
+    for (const Operation& op : kOperations) {
+      measure(ina, devices, op, false, iterations);
+      if (!op.singleOnly) measure(ina, devices, op, true, iterations);
+    }  // for-next each operation
+  }    // for-next each clock rate
+  return 0;
+}  // of function main()
@@ -0,0 +1,62 @@
+/*!
+ * @file EEPROM.h
+ *
+ * @brief Host-side stand-in for the Arduino EEPROM library
+ *
+ * @section EEPROM_host_intro_section Description
+ *
+ * A 1KB RAM array (the size of an ATmega328 EEPROM) replaces the EEPROM. Every byte moved in or
+ * out is counted so that benchmarks can report how often the library touches its configuration
+ * storage. The "begin()" and "commit()" calls of the ESP32/ESP8266 variant are accepted as well.
+ *
+ */
+#ifndef INA_HOST_EEPROM_H
+/*! Guard code definition to prevent multiple includes */
+#define INA_HOST_EEPROM_H
+#include "Arduino.h"
+
+class EEPROMClass {
+  /*!
+   * @class   EEPROMClass
+   * @brief   RAM backed EEPROM emulation which counts accesses
+   */
+ public:
+  static const uint16_t kSize = 1024;  ///< Emulated EEPROM size in bytes
+  uint8_t               read(const int idx) {
+    ++bytesRead;
+    return _data[idx % kSize];
+  }  // of method read()
+  void write(const int idx, const uint8_t val) {
+    ++bytesWritten;
+    _data[idx % kSize] = val;
+  }  // of method write()
+  void update(const int idx, const uint8_t val) {
+    if (read(idx) != val) { write(idx, val); }
+  }  // of method update()
+  uint16_t length() const { return kSize; }
+  template <typename T>
+  T& get(const int idx, T& t) {
+    ++gets;
+    uint8_t* ptr = (uint8_t*)&t;
+    for (size_t i = 0; i < sizeof(T); ++i) { ptr[i] = read(idx + i); }
+    return t;
+  }  // of method get()
+  template <typename T>
+  const T& put(const int idx, const T& t) {
+    ++puts;
+    const uint8_t* ptr = (const uint8_t*)&t;
+    for (size_t i = 0; i < sizeof(T); ++i) { update(idx + i, ptr[i]); }
+    return t;
+  }  // of method put()
+  bool     begin(const size_t) { return true; }
+  bool     commit() { return true; }
+  void     resetStats() { gets = puts = bytesRead = bytesWritten = 0; }
+  uint32_t gets{0};          ///< Number of EEPROM.get() calls
+  uint32_t puts{0};          ///< Number of EEPROM.put() calls
+  uint32_t bytesRead{0};     ///< Number of bytes read
+  uint32_t bytesWritten{0};  ///< Number of bytes physically written
+ private:
+  uint8_t _data[kSize]{};  ///< Emulated EEPROM contents
+};                         // of class EEPROMClass
+extern EEPROMClass EEPROM;  ///< Global instance, as in the Arduino core
+#endif
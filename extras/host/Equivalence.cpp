@@ -0,0 +1,152 @@
+/*!
+ * @file Equivalence.cpp
+ *
+ * @brief Host-side check that the fixed-point conversions match the integer divisions they replace
+ *
+ * @section Equivalence_intro_section Description
+ *
+ * With cached descriptors the library converts raw register values with a precomputed multiplier
+ * and shift per device (see "inaFactors::fixedPoint()" and "fixedScale()") instead of 64 bit
+ * divisions, without them it divides by the same factors (see "scale()"). This program attaches
+ * one simulated device of each type, calls "begin()" with and without the descriptor cache for a
+ * range of maximum currents and shunt resistances and feeds every raw register value through
+ * "convertSample()", the same conversion used by readAll(), the asynchronous reads and the
+ * samples. Each result is compared with the 64 bit division formula it replaced:\n
+ * - INA219, INA226, INA230, INA231 and INA260: raw * LSB / 100, / 10 or / 1000 as before\n
+ * - INA228: the exact LSBs, 195.3125uV, 78.125nV or 312.5nV, maxBusAmps / 2^19 and 3.2 times that\n
+ * - INA3221: shunt raw * shunt LSB * 100000 / microOhmR and, for the power, the product of the raw
+ *   shunt and bus values times both LSBs / microOhmR\n\n
+ * The 16 bit registers are swept completely, the 24 bit INA228 registers every value. The first
+ * mismatches are printed and the program exits with 1 if there were any.\n\n
+ * Usage: ina_equivalence
+ *
+ */
+#include <INA.h>
+#include <Wire.h>
+
+#include <cstdio>
+#include <cstring>
+
+#include "INASim.h"
+
+/*! Maximum current and shunt pair passed to "begin()" */
+struct Range {
+  uint16_t maxBusAmps;  ///< Maximum expected current in Amps
+  uint32_t microOhmR;   ///< Shunt resistance in micro-ohms
+};
+/*! Ranges checked, including both INA228 ADCRANGE settings and shunts which don't divide 1 Ohm */
+static const Range kRanges[] = {{1, 100000}, {2, 1000},  {4, 20000}, {5, 3300},
+                                {20, 2000},  {80, 470},  {400, 150}, {1022, 100}};
+
+static SimDevice ina219(SIM_INA219, 0x40);    ///< Device checked
+static SimDevice ina226(SIM_INA226, 0x41);    ///< Device checked
+static SimDevice ina228(SIM_INA228, 0x42);    ///< Device checked
+static SimDevice ina230(SIM_INA230, 0x43);    ///< Device checked
+static SimDevice ina231(SIM_INA231, 0x44);    ///< Device checked
+static SimDevice ina260(SIM_INA260, 0x45);    ///< Device checked
+static SimDevice ina3221(SIM_INA3221, 0x46);  ///< Device checked, all 3 channels
+
+static uint32_t mismatches = 0;  ///< Number of results which differed
+static uint64_t compared   = 0;  ///< Number of results compared
+
+static uint8_t deviceType(const char* name) {
+  /*! @brief Returns the "ina_Type" of a device name as returned by "getDeviceName()" */
+  static const char* const kNames[] = {"INA219", "INA226", "INA228",   "INA230",
+                                       "INA231", "INA260", "INA3221"};
+  for (uint8_t i = 0; i < sizeof(kNames) / sizeof(kNames[0]); ++i) {
+    if (strcmp(name, kNames[i]) == 0) return i;  // INA3221 channels all convert like INA3221_0
+  }  // for-next each name
+  return INA_UNKNOWN;
+}  // of function deviceType()
+
+static bool cached = true;  ///< Whether the instance checked caches the descriptors
+
+static void expect(const char* name, const char* value, const Range& range, const int32_t raw,
+                   const int64_t converted, const int64_t division) {
+  /*! @brief Counts a comparison and reports it if the two results differ */
+  ++compared;
+  if (converted == division) return;
+  if (++mismatches <= 20) {
+    printf("%-7s %3uA %7uuOhm %-5s raw %9d: %s %lld, division %lld\n", name, range.maxBusAmps,
+           range.microOhmR, value, raw, cached ? "fixed-point" : "uncached", (long long)converted,
+           (long long)division);
+  }  // if-then still reporting
+}  // of function expect()
+
+static void check(INA_Class& ina, const uint8_t deviceNumber, const Range& range) {
+  /*! @brief Compares every raw value of one device with the division formulas */
+  const char* name = ina.getDeviceName(deviceNumber);
+  inaEEPROM   stored{};
+  stored.type       = deviceType(name);
+  stored.maxBusAmps = range.maxBusAmps;
+  stored.microOhmR  = range.microOhmR;
+  const inaDet  dev(stored);  // The LSBs the library works with
+  const bool    wide    = stored.type == INA228;
+  const bool    ina3221 = stored.type == INA3221_0;
+  const int32_t count   = wide ? 0x1000000 : 0x10000;
+  inaSample     sample{};
+  inaReading    reading;
+  sample.deviceNumber = deviceNumber;
+  for (int32_t value = 0; value < count; ++value) {
+    const int32_t word = (int16_t)value;  // As returned by readWord()
+    for (uint8_t role = INA_ROLE_BUS; role < INA_ROLE_CONFIG; ++role) {
+      sample.raw[role] = wide ? value : word;
+    }  // for-next each register role
+    ina.convertSample(sample, reading);
+    int64_t busMilliVolts, shuntMicroVolts, busMicroAmps, busMicroWatts;
+    if (wide) {  // 20 bit values in the top of the 24 bit registers
+      const int32_t signedRaw = (int32_t)((uint32_t)value << 8) >> 12;  // Sign extended
+      const bool    low       = (uint32_t)range.maxBusAmps * range.microOhmR <=
+                         INA228_LOW_RANGE_MICROVOLTS;  // ADCRANGE set
+      busMilliVolts           = (int64_t)(value >> 4) * 1953125 / 10000000;
+      shuntMicroVolts         = (int64_t)signedRaw * 5 / (low ? 64 : 16);
+      busMicroAmps            = (int64_t)signedRaw * range.maxBusAmps * 15625 / 8192;
+      busMicroWatts           = (int64_t)value * range.maxBusAmps * 3125 / 512;
+      if (signedRaw < 0) busMicroWatts = -busMicroWatts;
+    } else if (ina3221) {  // The 3 LSB are unused
+      const int32_t  shuntRaw = word >> 3;
+      const uint32_t busRaw   = (uint16_t)word >> 3;
+      busMilliVolts           = (int64_t)busRaw * dev.busVoltage_LSB / 100;
+      shuntMicroVolts         = (int64_t)shuntRaw * dev.shuntVoltage_LSB / 10;
+      busMicroAmps  = (int64_t)shuntRaw * dev.shuntVoltage_LSB * 100000 / range.microOhmR;
+      busMicroWatts = (int64_t)shuntRaw * busRaw * dev.shuntVoltage_LSB * dev.busVoltage_LSB /
+                      range.microOhmR;
+    } else {
+      const uint32_t busRaw = stored.type == INA219 ? (uint16_t)word >> 3 : (uint16_t)word;
+      busMilliVolts         = (int64_t)busRaw * dev.busVoltage_LSB / 100;
+      busMicroAmps          = (int64_t)word * dev.current_LSB / 1000;
+      busMicroWatts         = (int64_t)word * dev.power_LSB / 1000;
+      if (stored.type == INA260) {  // No shunt register, see "getShuntMicroVolts()"
+        shuntMicroVolts = busMicroAmps / 200;
+        if (busMicroAmps / 200 / 1000 < 0) busMicroWatts = -busMicroWatts;
+      } else {
+        shuntMicroVolts = (int64_t)word * dev.shuntVoltage_LSB / 10;
+        if (word < 0) busMicroWatts = -busMicroWatts;
+      }  // if-then-else an INA260
+    }    // if-then-else device family
+    inaReading expected;  // Stored with the field widths of the reading, as the old code did
+    expected.busMilliVolts   = busMilliVolts;
+    expected.shuntMicroVolts = shuntMicroVolts;
+    expected.busMicroAmps    = busMicroAmps;
+    expected.busMicroWatts   = busMicroWatts;
+    expect(name, "mV", range, value, reading.busMilliVolts, expected.busMilliVolts);
+    expect(name, "uV", range, value, reading.shuntMicroVolts, expected.shuntMicroVolts);
+    expect(name, "uA", range, value, reading.busMicroAmps, expected.busMicroAmps);
+    expect(name, "uW", range, value, reading.busMicroWatts, expected.busMicroWatts);
+  }  // for-next each raw value
+}  // of function check()
+
+int main() {
+  SimDevice* devices[] = {&ina219, &ina226, &ina228, &ina230, &ina231, &ina260, &ina3221};
+  for (SimDevice* device : devices) { SimDefaultBus.attach(device); }
+  for (uint8_t pass = 0; pass < 2; ++pass) {
+    cached = pass == 0;
+    for (const Range& range : kRanges) {
+      INA_Class     ina(0, cached);
+      const uint8_t found = ina.begin(range.maxBusAmps, range.microOhmR);
+      for (uint8_t d = 0; d < found; ++d) { check(ina, d, range); }
+    }  // for-next each range
+  }    // for-next with and without the descriptor cache
+  printf("%llu conversions compared, %u mismatches\n", (unsigned long long)compared, mismatches);
+  return mismatches ? 1 : 0;
+}  // of function main()
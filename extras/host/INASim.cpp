@@ -0,0 +1,454 @@
+/*!
+ * @file INASim.cpp
+ *
+ * @section INASim_cpp_intro_section Description
+ *
+ * Implementation of the simulated clock, the simulated I2C bus and the INA register models. See
+ * "INASim.h" for details. Register addresses, reset values and scaling are taken from the Texas
+ * Instruments datasheets of the respective devices.
+ *
+ */
+#include "INASim.h"
+
+#include "EEPROM.h"
+
+SimBus      SimDefaultBus;  ///< Bus that the global "Wire" instance is attached to
+EEPROMClass EEPROM;         ///< Emulated EEPROM instance
+static uint64_t simulatedNanos{0};         ///< Simulated clock
+uint8_t         hostStatusRegister{0x80};  ///< AVR SREG stand-in, the I flag set
+
+/***************************************************************************************************
+** Simulated clock and the Arduino timing functions which are based on it                         **
+***************************************************************************************************/
+uint64_t simNanos() { return simulatedNanos; }
+void     simAdvance(const uint64_t nanos) { simulatedNanos += nanos; }
+uint32_t micros() { return (uint32_t)(simulatedNanos / 1000); }
+uint32_t millis() { return (uint32_t)(simulatedNanos / 1000000); }
+void     delayMicroseconds(uint32_t micros) { simAdvance((uint64_t)micros * 1000); }
+void     delay(uint32_t millis) { simAdvance((uint64_t)millis * 1000000); }
+void     yield() {}
+
+/***************************************************************************************************
+** Conversion time tables in microseconds, indexed by the value of the configuration bit fields   **
+***************************************************************************************************/
+static const uint32_t kIna219AdcMicros[16] = {84,  148,  276,  532,  84,    148,   276,   532,
+                                              532, 1060, 2130, 4260, 8510, 17020, 34050, 68100};
+static const uint32_t kIna226CtMicros[8]   = {140, 204, 332, 588, 1100, 2116, 4156, 8244};
+static const uint32_t kIna228CtMicros[8]   = {50, 84, 150, 280, 540, 1052, 2074, 4120};
+static const uint16_t kAveraging[8]        = {1, 4, 16, 64, 128, 256, 512, 1024};
+
+static int64_t clamp(const int64_t value, const int64_t low, const int64_t high) {
+  return value < low ? low : (value > high ? high : value);
+}  // of function clamp()
+static int64_t absolute(const int64_t value) { return value < 0 ? -value : value; }
+static bool    ina226Like(const SimDeviceType type) {
+  return type == SIM_INA226 || type == SIM_INA230 || type == SIM_INA231 || type == SIM_INA260;
+}  // of function ina226Like()
+
+SimDevice::SimDevice(const SimDeviceType type, const uint8_t address)
+    : type(type), address(address) {
+  for (uint8_t c = 0; c < 3; ++c) {
+    busMicroVolts[c]  = 0;
+    shuntNanoVolts[c] = 0;
+  }  // for-next each channel
+  powerOn();
+}  // of constructor
+void SimDevice::powerOn() {
+  /*! @brief Restore every register to its power-on value and start converting */
+  for (uint16_t i = 0; i < 256; ++i) { _regs[i] = 0; }
+  _pointer = 0;
+  _energy  = 0;
+  _charge  = 0;
+  switch (type) {
+    case SIM_INA219: _regs[0] = 0x399F; break;
+    case SIM_INA226:
+    case SIM_INA230:
+    case SIM_INA231:
+      _regs[0] = 0x4127;
+      if (type == SIM_INA226) {
+        _regs[0xFE] = 0x5449;  // "TI"
+        _regs[0xFF] = 0x2260;
+      } else if (type == SIM_INA230) {  // No ID registers, identified after a reset
+        _regs[0xFF] = 0x2300;  // The library only checks for zero / non-zero here
+      }                        // of if-then-else INA226
+      break;
+    case SIM_INA260:
+      _regs[0]    = 0x6127;
+      _regs[0xFE] = 0x5449;
+      _regs[0xFF] = 0x2270;
+      break;
+    case SIM_INA3221:
+      _regs[0] = 0x7127;
+      for (uint8_t reg = 7; reg <= 12; ++reg) { _regs[reg] = 0x7FF8; }  // Critical/warning limits
+      _regs[0x0E] = 0x7FFE;  // Shunt-voltage sum limit
+      _regs[0x0F] = 0x0002;  // Mask/enable
+      _regs[0x10] = 0x2710;  // Power-valid upper limit
+      _regs[0x11] = 0x2328;  // Power-valid lower limit
+      _regs[0xFE] = 0x5449;
+      _regs[0xFF] = 0x3220;
+      break;
+    case SIM_INA228:
+      _regs[0x01] = 0xFB68;  // ADC_CONFIG, continuous bus/shunt/temperature
+      _regs[0x02] = 0x1000;  // SHUNT_CAL
+      _regs[0x0B] = 0x0001;  // DIAG_ALRT
+      _regs[0x0C] = 0x7FFF;  // SOVL
+      _regs[0x0D] = 0x8000;  // SUVL
+      _regs[0x0E] = 0x7FFF;  // BOVL
+      _regs[0x10] = 0x7FFF;  // TEMP_LIMIT
+      _regs[0x11] = 0xFFFF;  // PWR_LIMIT
+      _regs[0x3E] = 0x5449;
+      _regs[0x3F] = 0x2281;
+      break;
+  }  // of switch type
+  startConversion();
+}  // of method powerOn()
+uint8_t SimDevice::registerWidth(const uint8_t reg) const {
+  /*! @brief Only the INA228 has registers which are wider than 16 bits */
+  if (type == SIM_INA228) {
+    if (reg == 0x04 || reg == 0x05 || reg == 0x07 || reg == 0x08) return 3;
+    if (reg == 0x09 || reg == 0x0A) return 5;
+  }  // of if-then an INA228
+  return 2;
+}  // of method registerWidth()
+uint8_t SimDevice::modeBits() const {
+  if (type == SIM_INA228) return (_regs[1] >> 12) & 0xF;
+  return _regs[0] & 0x7;
+}  // of method modeBits()
+bool SimDevice::continuous() const {
+  if (type == SIM_INA228) return modeBits() & 0x8;
+  return modeBits() & 0x4;
+}  // of method continuous()
+uint32_t SimDevice::conversionMicros() const {
+  /*! @brief Time for one complete conversion cycle (including averaging) with current settings */
+  const uint16_t config = _regs[0];
+  const uint8_t  mode   = modeBits();
+  uint32_t       cycle  = 0;
+  switch (type) {
+    case SIM_INA219:
+      if (mode & 2) cycle += kIna219AdcMicros[(config >> 7) & 0xF];
+      if (mode & 1) cycle += kIna219AdcMicros[(config >> 3) & 0xF];
+      break;
+    case SIM_INA228: {
+      const uint16_t adc = _regs[1];
+      if (mode & 1) cycle += kIna228CtMicros[(adc >> 9) & 7];
+      if (mode & 2) cycle += kIna228CtMicros[(adc >> 6) & 7];
+      if (mode & 4) cycle += kIna228CtMicros[(adc >> 3) & 7];
+      cycle *= kAveraging[adc & 7];
+      break;
+    }  // of INA228
+    default:
+      if (mode & 2) cycle += kIna226CtMicros[(config >> 6) & 7];
+      if (mode & 1) cycle += kIna226CtMicros[(config >> 3) & 7];
+      if (type == SIM_INA3221) {
+        uint8_t channels = 0;
+        for (uint8_t c = 0; c < 3; ++c) {
+          if (config & (0x4000 >> c)) ++channels;
+        }  // for-next each channel
+        cycle *= channels;
+      }  // of if-then an INA3221 with up to 3 channels
+      cycle *= kAveraging[(config >> 9) & 7];
+  }  // of switch type
+  return cycle ? cycle : 1;
+}  // of method conversionMicros()
+void SimDevice::startConversion() {
+  /*! @brief Writing the mode (or resetting) aborts the current conversion and starts a new one */
+  const uint8_t measured = type == SIM_INA228 ? (modeBits() & 7) : (modeBits() & 3);
+  _converting            = measured != 0;
+  _doneAt                = simNanos() + (uint64_t)conversionMicros() * 1000;
+}  // of method startConversion()
+void SimDevice::update() {
+  /*! @brief Latch every conversion which has finished since the last access */
+  if (!_converting || simNanos() < _doneAt) return;
+  if (continuous()) {
+    const uint64_t period = (uint64_t)conversionMicros() * 1000;
+    const uint64_t count  = (simNanos() - _doneAt) / period + 1;
+    _doneAt += count * period;
+    latch((uint32_t)count);
+  } else {
+    _converting = false;
+    latch(1);
+  }  // of if-then-else continuous mode
+}  // of method update()
+void SimDevice::latch(const uint32_t count) {
+  /*! @brief Compute the result registers from the physical inputs, as the device would */
+  const uint8_t mode = modeBits();
+  conversions += count;
+  switch (type) {
+    case SIM_INA219: {
+      if (mode & 1) _regs[1] = (uint16_t)clamp(shuntNanoVolts[0] / 10000, -32768, 32767);
+      if (mode & 2) {
+        const int64_t bus = clamp(busMicroVolts[0] / 4000, 0, 8191);
+        _regs[2]          = (uint16_t)(bus << 3);
+      }  // of if-then bus measured
+      const int64_t shunt   = (int16_t)_regs[1];
+      const int64_t current = clamp(shunt * (int64_t)_regs[5] / 4096, -32768, 32767);
+      _regs[4]              = (uint16_t)current;
+      _regs[3] = (uint16_t)clamp(absolute(current) * (int64_t)(_regs[2] >> 3) / 5000, 0, 65535);
+      _regs[2] |= 2;  // CNVR
+      break;
+    }  // of INA219
+    case SIM_INA226:
+    case SIM_INA230:
+    case SIM_INA231: {
+      if (mode & 1) _regs[1] = (uint16_t)clamp(shuntNanoVolts[0] / 2500, -32768, 32767);
+      if (mode & 2) _regs[2] = (uint16_t)clamp(busMicroVolts[0] / 1250, 0, 0x7FFF);
+      const int64_t shunt   = (int16_t)_regs[1];
+      const int64_t current = clamp(shunt * (int64_t)_regs[5] / 2048, -32768, 32767);
+      _regs[4]              = (uint16_t)current;
+      _regs[3] = (uint16_t)clamp(absolute(current) * (int64_t)_regs[2] / 20000, 0, 65535);
+      _regs[6] |= 0x0008;  // CVRF
+      break;
+    }  // of INA226, INA230, INA231
+    case SIM_INA260: {
+      if (mode & 1) _regs[1] = (uint16_t)clamp(shuntNanoVolts[0] / 2 / 1250, -32768, 32767);
+      if (mode & 2) _regs[2] = (uint16_t)clamp(busMicroVolts[0] / 1250, 0, 0x7FFF);
+      _regs[3] = (uint16_t)clamp(absolute((int16_t)_regs[1]) * (int64_t)_regs[2] / 6400, 0, 65535);
+      _regs[6] |= 0x0008;  // CVRF
+      break;
+    }  // of INA260
+    case SIM_INA3221: {
+      int64_t sum = 0;
+      for (uint8_t c = 0; c < 3; ++c) {
+        if (!(_regs[0] & (0x4000 >> c))) continue;  // Channel disabled
+        const int64_t shunt = clamp(shuntNanoVolts[c] / 40000, -4096, 4095);
+        const int64_t bus   = clamp(busMicroVolts[c] / 8000, 0, 4095);
+        if (mode & 1) _regs[1 + 2 * c] = (uint16_t)(shunt * 8);
+        if (mode & 2) _regs[2 + 2 * c] = (uint16_t)(bus * 8);
+        if (_regs[0x0F] & (0x4000 >> c)) sum += (int16_t)_regs[1 + 2 * c] >> 3;
+      }  // for-next each channel
+      _regs[0x0D] = (uint16_t)(clamp(sum, -16384, 16383) << 1);
+      _regs[0x0F] |= 0x0001;  // CVRF
+      break;
+    }  // of INA3221
+    case SIM_INA228: {
+      const bool    highRange = _regs[0] & 0x0010;  // ADCRANGE, 78.125nV instead of 312.5nV
+      const int64_t shunt     = clamp((int64_t)shuntNanoVolts[0] * (highRange ? 8 : 2) / 625,
+                                  -524288, 524287);
+      const int64_t bus       = clamp((int64_t)busMicroVolts[0] * 16 / 3125, 0, 524287);
+      if (mode & 2) _regs[4] = ((uint64_t)shunt << 4) & 0xFFFFFF;
+      if (mode & 1) _regs[5] = ((uint64_t)bus << 4) & 0xFFFFFF;
+      _regs[6]                = 3200 << 4;  // 25 degrees C
+      const uint16_t cal      = _regs[2] & 0x7FFF;
+      const int64_t  current  = cal ? clamp(shunt * 4096 / cal, -524288, 524287) : 0;
+      const int64_t  power    = clamp(absolute(current) * bus / 16384, 0, 0xFFFFFF);
+      _regs[7]                = ((uint64_t)current << 4) & 0xFFFFFF;
+      _regs[8]                = (uint64_t)power;
+      const double seconds    = (double)count * conversionMicros() / 1e6;
+      _energy += (double)power * seconds / 16.0;
+      _charge += (double)current * seconds;
+      _regs[9]  = (uint64_t)_energy & 0xFFFFFFFFFFULL;
+      _regs[10] = (uint64_t)(int64_t)_charge & 0xFFFFFFFFFFULL;
+      _regs[0x0B] |= 0x0002;  // CNVRF
+      break;
+    }  // of INA228
+  }    // of switch type
+  evaluateAlerts();
+}  // of method latch()
+void SimDevice::evaluateAlerts() {
+  /*! @brief Set the alert function flags from the latest results and the limit registers */
+  if (ina226Like(type)) {
+    const uint16_t mask  = _regs[6];
+    const uint16_t limit = _regs[7];
+    bool           alert = false;
+    if (mask & 0x8000) alert |= (int16_t)_regs[1] > (int16_t)limit;
+    if (mask & 0x4000) alert |= (int16_t)_regs[1] < (int16_t)limit;
+    if (mask & 0x2000) alert |= _regs[2] > limit;
+    if (mask & 0x1000) alert |= _regs[2] < limit;
+    if (mask & 0x0800) alert |= _regs[3] > limit;
+    if (alert) {
+      _regs[6] |= 0x0010;  // AFF
+    } else if (!(mask & 0x0001)) {
+      _regs[6] &= ~0x0010;  // Transparent mode follows the latest conversion
+    }                       // of if-then-else alert function flag
+  } else if (type == SIM_INA3221) {
+    uint16_t flags = 0;
+    for (uint8_t c = 0; c < 3; ++c) {
+      if (!(_regs[0] & (0x4000 >> c))) continue;
+      const int16_t shunt = (int16_t)_regs[1 + 2 * c];
+      if (shunt > (int16_t)_regs[7 + 2 * c]) flags |= 0x0200 >> c;  // CF1-3
+      if (shunt > (int16_t)_regs[8 + 2 * c]) flags |= 0x0020 >> c;  // WF1-3
+    }                                                               // for-next each channel
+    if ((int16_t)_regs[0x0D] > (int16_t)_regs[0x0E]) flags |= 0x0040;  // SF
+    bool valid = true;
+    for (uint8_t c = 0; c < 3; ++c) {
+      if ((_regs[0] & (0x4000 >> c)) && _regs[2 + 2 * c] < _regs[0x10]) valid = false;
+    }  // for-next each channel
+    if (valid) flags |= 0x0004;  // PVF
+    uint16_t keep = 0x7C01;      // Control bits and CVRF
+    if (_regs[0x0F] & 0x0400) keep |= 0x0380;  // Critical flags are latched
+    if (_regs[0x0F] & 0x0800) keep |= 0x0038;  // Warning flags are latched
+    _regs[0x0F] = (_regs[0x0F] & keep) | flags;
+  } else if (type == SIM_INA228) {
+    const int64_t shunt = (int64_t)(int32_t)(_regs[4] << 8) >> 12;  // Sign-extended 20 bits
+    const int64_t bus   = _regs[5] >> 4;
+    uint16_t      flags = 0;
+    if (shunt / 16 > (int16_t)_regs[0x0C]) flags |= 0x0040;  // SHNTOL
+    if (shunt / 16 < (int16_t)_regs[0x0D]) flags |= 0x0020;  // SHNTUL
+    if (bus / 16 > (int64_t)_regs[0x0E]) flags |= 0x0010;    // BUSOL
+    if (bus / 16 < (int64_t)_regs[0x0F]) flags |= 0x0008;    // BUSUL
+    if (_regs[8] / 256 > _regs[0x11]) flags |= 0x0004;       // POL
+    if (_regs[0x0B] & 0x8000) {
+      _regs[0x0B] |= flags;  // Latched
+    } else {
+      _regs[0x0B] = (_regs[0x0B] & ~0x007C) | flags;
+    }  // of if-then-else latched alerts
+  }    // of if-then-else device type
+}  // of method evaluateAlerts()
+void SimDevice::writeRegister(const uint8_t reg, const uint16_t value) {
+  /*! @brief Write a register, honouring read-only registers, reserved bits and reset bits */
+  ++registerWrites;
+  if (reg == 0 && (value & 0x8000)) {
+    powerOn();  // Software reset, the bit clears itself
+    return;
+  }  // of if-then reset requested
+  switch (type) {
+    case SIM_INA219:
+      if (reg == 0) {
+        _regs[0] = value;
+        startConversion();
+      } else if (reg == 5) {
+        _regs[5] = value & 0xFFFE;
+      }  // of if-then-else writable register
+      break;
+    case SIM_INA226:
+    case SIM_INA230:
+    case SIM_INA231:
+    case SIM_INA260:
+      if (reg == 0) {
+        _regs[0] = value;
+        startConversion();
+      } else if (reg == 5 && type != SIM_INA260) {
+        _regs[5] = value & 0x7FFF;
+      } else if (reg == 6) {
+        _regs[6] = (value & 0xFC03) | (_regs[6] & 0x001C);  // Flags are read-only
+      } else if (reg == 7) {
+        _regs[7] = value;
+      }  // of if-then-else writable register
+      break;
+    case SIM_INA3221:
+      if (reg == 0) {
+        _regs[0] = value;
+        startConversion();
+      } else if (reg >= 7 && reg <= 12) {
+        _regs[reg] = value & 0xFFF8;
+      } else if (reg == 0x0E) {
+        _regs[reg] = value & 0xFFFE;
+      } else if (reg == 0x0F) {
+        _regs[reg] = (value & 0x7C00) | (_regs[reg] & 0x03FF);  // Flags are read-only
+      } else if (reg == 0x10 || reg == 0x11) {
+        _regs[reg] = value & 0xFFF8;
+      }  // of if-then-else writable register
+      break;
+    case SIM_INA228:
+      if (reg == 0) {
+        if (value & 0x4000) {  // RSTACC clears the accumulators and clears itself
+          _energy = _charge = 0;
+          _regs[9] = _regs[10] = 0;
+        }  // of if-then reset accumulators
+        _regs[0] = value & 0x3FFF;
+      } else if (reg == 1) {
+        _regs[1] = value;
+        startConversion();
+      } else if (reg == 2) {
+        _regs[2] = value & 0x7FFF;
+      } else if (reg == 3) {
+        _regs[3] = value & 0x3FFF;
+      } else if (reg == 0x0B) {
+        _regs[0x0B] = (value & 0xF000) | (_regs[0x0B] & 0x0FFF);  // Flags are read-only
+      } else if (reg >= 0x0C && reg <= 0x11) {
+        _regs[reg] = value;
+      }  // of if-then-else writable register
+      break;
+  }  // of switch type
+}  // of method writeRegister()
+void SimDevice::receive(const uint8_t* data, const uint8_t length) {
+  /*! @brief A write transaction sets the pointer and, with 2 more bytes, writes that register */
+  update();
+  if (length == 0) return;  // Address probe only
+  _oldPointer = _pointer;
+  _pointer    = data[0];
+  ++pointerWrites;
+  if (length >= 3) writeRegister(_pointer, ((uint16_t)data[1] << 8) | data[2]);
+}  // of method receive()
+void SimDevice::stopped() {
+  /*! @brief The pointer written by the last write transaction settles "settleNanos" from now */
+  _pointerAt = simNanos();
+}  // of method stopped()
+uint8_t SimDevice::transmit(uint8_t* data, const uint8_t length) {
+  /*! @brief A read transaction returns the pointed-to register MSB first. The pointer does not
+             auto-increment, so reading past the register width repeats the same register. Until
+             the last pointer write has settled the previous register is returned */
+  update();
+  ++registerReads;
+  const uint8_t  reg   = simNanos() - _pointerAt < settleNanos ? _oldPointer : _pointer;
+  const uint64_t value = _regs[reg];
+  const uint8_t  width = registerWidth(reg);
+  for (uint8_t i = 0; i < length; ++i) {
+    data[i] = (uint8_t)(value >> (8 * (width - 1 - i % width)));
+  }  // for-next each byte requested
+  if (type == SIM_INA219 && reg == 3) {
+    _regs[2] &= ~0x0002;  // Reading power clears CNVR
+  } else if (ina226Like(type) && reg == 6) {
+    _regs[6] &= ~0x0008;                                // Reading mask/enable clears CVRF
+    if (_regs[6] & 0x0001) _regs[6] &= ~0x0010;         // and a latched AFF
+  } else if (type == SIM_INA3221 && reg == 0x0F) {
+    _regs[0x0F] &= ~0x0001;                             // Reading mask/enable clears CVRF
+    if (_regs[0x0F] & 0x0400) _regs[0x0F] &= ~0x0380;  // and latched critical flags
+    if (_regs[0x0F] & 0x0800) _regs[0x0F] &= ~0x0038;  // and latched warning flags
+  } else if (type == SIM_INA228 && reg == 0x0B) {
+    _regs[0x0B] &= ~0x0002;                             // Reading DIAG_ALRT clears CNVRF
+    if (_regs[0x0B] & 0x8000) _regs[0x0B] &= ~0x007C;  // and latched alert flags
+  }                                                     // of if-then-else clear-on-read
+  return length;
+}  // of method transmit()
+uint64_t SimDevice::peekRegister(const uint8_t reg) {
+  /*! @brief Return a register without any clear-on-read side effects */
+  update();
+  return _regs[reg];
+}  // of method peekRegister()
+bool SimDevice::alertAsserted() {
+  /*! @brief Logical state of the ALERT pin, or of the WARNING pin for the INA3221 */
+  update();
+  if (ina226Like(type)) {
+    return ((_regs[6] & 0x0400) && (_regs[6] & 0x0008)) || (_regs[6] & 0x0010);
+  } else if (type == SIM_INA3221) {
+    return _regs[0x0F] & 0x0038;
+  } else if (type == SIM_INA228) {
+    return ((_regs[0x0B] & 0x4000) && (_regs[0x0B] & 0x0002)) || (_regs[0x0B] & 0x007C);
+  }  // of if-then-else device type
+  return false;
+}  // of method alertAsserted()
+bool SimDevice::criticalAsserted() {
+  /*! @brief Logical state of the INA3221 CRITICAL pin */
+  update();
+  return type == SIM_INA3221 && (_regs[0x0F] & 0x03C0);
+}  // of method criticalAsserted()
+
+void SimBus::attach(SimDevice* device) {
+  if (_count < kMaxDevices) _devices[_count++] = device;
+}  // of method attach()
+SimDevice* SimBus::find(const uint8_t address) const {
+  for (uint8_t i = 0; i < _count; ++i) {
+    if (_devices[i]->address == address) return _devices[i];
+  }  // for-next each attached device
+  return nullptr;
+}  // of method find()
+SimDevice* SimBus::alertResponse() const {
+  /*! @brief The INA226-like device with the lowest address whose ALERT pin is asserted, as it
+             wins the arbitration on the Alert Response Address read */
+  SimDevice* winner = nullptr;
+  for (uint8_t i = 0; i < _count; ++i) {
+    if (!ina226Like(_devices[i]->type) || !_devices[i]->alertAsserted()) continue;
+    if (winner == nullptr || _devices[i]->address < winner->address) winner = _devices[i];
+  }  // for-next each attached device
+  return winner;
+}  // of method alertResponse()
+void SimBus::account(const uint8_t bytes, const bool stop) {
+  /*! @brief Count one address phase plus "bytes" data bytes, each with its ACK bit, and advance
+             the simulated clock by the time this takes at the current bus clock */
+  const uint32_t bits  = 1 + 9 * (1 + (uint32_t)bytes) + (stop ? 1 : 0);  // START, bytes, STOP
+  const uint64_t nanos = (uint64_t)bits * 1000000000 / clockHz;
+  ++stats.transactions;
+  stats.busNanos += nanos;
+  simAdvance(nanos);
+}  // of method account()
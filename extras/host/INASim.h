@@ -0,0 +1,111 @@
+/*!
+ * @file INASim.h
+ *
+ * @brief Register-level simulator for the INA2xx family, used for host-side benchmarking
+ *
+ * @section INASim_intro_section Description
+ *
+ * The simulator models the I2C register file of the INA219, INA226/INA230/INA231, INA228, INA260
+ * and INA3221 closely enough for the unmodified INA library to run against it:\n
+ * - the register pointer, register widths and power-on/reset values (including the values that
+ *   "begin()" uses to identify each device type)\n
+ * - the calibration register and the current/power registers derived from it\n
+ * - conversion timing derived from the averaging, conversion time and mode fields, including the
+ *   conversion-ready flags and the way each device clears them\n
+ * - the alert/limit functions of the mask/enable registers\n\n
+ * A SimBus counts transactions, bytes and the simulated time spent on the wire for the clock rate
+ * that was set with "Wire.setClock()". The physical inputs of each device (bus voltage and shunt
+ * voltage per channel) are set directly by the test program.
+ *
+ */
+#ifndef INA_HOST_INASIM_H
+/*! Guard code definition to prevent multiple includes */
+#define INA_HOST_INASIM_H
+#include "Arduino.h"
+
+/*! Device types which can be simulated */
+enum SimDeviceType {
+  SIM_INA219,
+  SIM_INA226,
+  SIM_INA228,
+  SIM_INA230,
+  SIM_INA231,
+  SIM_INA260,
+  SIM_INA3221
+};
+/*! Cumulative counters for one simulated bus */
+struct SimBusStats {
+  uint32_t transactions{0};  ///< Number of START / repeated START conditions
+  uint32_t nacks{0};         ///< Number of address phases not acknowledged
+  uint32_t bytesWritten{0};  ///< Data bytes written by the master (excluding address bytes)
+  uint32_t bytesRead{0};     ///< Data bytes read by the master
+  uint64_t busNanos{0};      ///< Simulated time spent on the wire
+};
+
+uint64_t simNanos();                        ///< Simulated time since start in nanoseconds
+void     simAdvance(const uint64_t nanos);  ///< Move the simulated clock forward
+
+class SimDevice {
+  /*!
+   * @class   SimDevice
+   * @brief   Register model of one INA device package
+   */
+ public:
+  SimDevice(const SimDeviceType type, const uint8_t address);
+  void     powerOn();                                      // Power-on reset of all registers
+  void     receive(const uint8_t* data, const uint8_t length);  // Master write transaction
+  void     stopped();                                           // STOP after a write
+  uint8_t  transmit(uint8_t* data, const uint8_t length);       // Master read transaction
+  uint64_t peekRegister(const uint8_t reg);        // Read without clear-on-read effects
+  uint8_t  registerWidth(const uint8_t reg) const;  // Register width in bytes
+  uint32_t conversionMicros() const;  // Time for one complete conversion cycle
+  bool     alertAsserted();           // State of the ALERT (INA3221: WARNING) pin
+  bool     criticalAsserted();        // State of the INA3221 CRITICAL pin
+  uint8_t  pointer() const { return _pointer; }
+  const SimDeviceType type;      ///< Type of device simulated
+  const uint8_t       address;   ///< I2C address of the device
+  int32_t  busMicroVolts[3];     ///< Physical bus voltage input per channel
+  int32_t  shuntNanoVolts[3];    ///< Physical shunt voltage input per channel
+  uint32_t conversions{0};       ///< Number of conversion results latched
+  uint32_t pointerWrites{0};     ///< Number of transactions which set the register pointer
+  uint32_t registerWrites{0};    ///< Number of register writes
+  uint32_t registerReads{0};     ///< Number of read transactions
+  uint32_t settleNanos{0};       ///< Time from a pointer write until reads use the new pointer
+ private:
+  void     writeRegister(const uint8_t reg, const uint16_t value);
+  void     startConversion();
+  void     update();
+  void     latch(const uint32_t count);
+  void     evaluateAlerts();
+  uint8_t  modeBits() const;
+  bool     continuous() const;
+  uint64_t _regs[256];          ///< Register file
+  uint8_t  _pointer{0};         ///< Register pointer
+  uint8_t  _oldPointer{0};      ///< Register pointer before the last pointer write
+  uint64_t _pointerAt{0};       ///< Simulated time the last pointer write ended
+  bool     _converting{false};  ///< A conversion is in progress
+  uint64_t _doneAt{0};          ///< Simulated time the current conversion finishes
+  double   _energy{0};          ///< INA228 energy accumulator (register LSBs)
+  double   _charge{0};          ///< INA228 charge accumulator (register LSBs)
+};                              // of class SimDevice
+
+class SimBus {
+  /*!
+   * @class   SimBus
+   * @brief   Simulated I2C bus with any number of attached SimDevices
+   */
+ public:
+  static const uint8_t kMaxDevices = 32;  ///< Devices which can be attached to one bus
+  void       attach(SimDevice* device);
+  SimDevice* find(const uint8_t address) const;
+  SimDevice* alertResponse() const;  // Device answering the SMBus Alert Response Address
+  void       account(const uint8_t bytes, const bool stop);
+  void       resetStats() { stats = SimBusStats(); }
+  uint32_t    clockHz{100000};  ///< Bus clock, set by "Wire.setClock()"
+  SimBusStats stats;            ///< Cumulative counters
+ private:
+  SimDevice* _devices[kMaxDevices]{};  ///< Attached devices
+  uint8_t    _count{0};                ///< Number of attached devices
+};                                     // of class SimBus
+extern SimBus SimDefaultBus;  ///< Bus that the global "Wire" instance is attached to
+#endif
@@ -0,0 +1,74 @@
+/*!
+ * @file Wire.cpp
+ *
+ * @section Wire_cpp_intro_section Description
+ *
+ * Host-side TwoWire implementation which routes all traffic to a simulated bus, see "Wire.h"
+ *
+ */
+#include "Wire.h"
+
+#include "INASim.h"
+
+TwoWire Wire(&SimDefaultBus);  ///< Global instance attached to the default simulated bus
+
+TwoWire::TwoWire(SimBus* bus) : _bus(bus) {}
+void TwoWire::begin() {}
+void TwoWire::setClock(const uint32_t clock) { _bus->clockHz = clock; }
+void TwoWire::beginTransmission(const int address) {
+  _txAddress = (uint8_t)address;
+  _txLength  = 0;
+}  // of method beginTransmission()
+size_t TwoWire::write(const uint8_t data) {
+  if (_txLength >= kBufferLength) return 0;
+  _txBuffer[_txLength++] = data;
+  return 1;
+}  // of method write()
+size_t TwoWire::write(const uint8_t* data, const size_t quantity) {
+  size_t written = 0;
+  while (written < quantity && write(data[written])) { ++written; }
+  return written;
+}  // of method write()
+uint8_t TwoWire::endTransmission(const uint8_t sendStop) {
+  /*! @brief Send the buffered bytes. Returns 2 (address NACK) if no device answers */
+  SimDevice* device = _bus->find(_txAddress);
+  if (device == nullptr) {
+    ++_bus->stats.nacks;
+    _bus->account(0, true);
+    return 2;
+  }  // of if-then no device at that address
+  device->receive(_txBuffer, _txLength);
+  _bus->stats.bytesWritten += _txLength;
+  _bus->account(_txLength, sendStop);
+  device->stopped();
+  _txLength = 0;
+  return 0;
+}  // of method endTransmission()
+uint8_t TwoWire::requestFrom(const int address, const int quantity, const int sendStop) {
+  /*! @brief Read up to "quantity" bytes into the receive buffer, returns the number received */
+  const uint8_t length = quantity > kBufferLength ? kBufferLength : (uint8_t)quantity;
+  SimDevice*    device = _bus->find((uint8_t)address);
+  _rxIndex             = 0;
+  _rxLength            = 0;
+  if (address == kAlertResponseAddress && (device = _bus->alertResponse()) != nullptr) {
+    _rxBuffer[0] = device->address << 1;  // Alert Response: the 7 bit address, LSB unused
+    _rxLength    = 1;
+    _bus->stats.bytesRead += _rxLength;
+    _bus->account(_rxLength, sendStop);
+    return _rxLength;
+  }  // of if-then an alerting device answers the Alert Response Address
+  if (device == nullptr) {
+    ++_bus->stats.nacks;
+    _bus->account(0, true);
+    return 0;
+  }  // of if-then no device at that address
+  _rxLength = device->transmit(_rxBuffer, length);
+  _bus->stats.bytesRead += _rxLength;
+  _bus->account(_rxLength, sendStop);
+  return _rxLength;
+}  // of method requestFrom()
+int TwoWire::available() const { return _rxLength - _rxIndex; }
+int TwoWire::read() {
+  if (_rxIndex >= _rxLength) return -1;
+  return _rxBuffer[_rxIndex++];
+}  // of method read()
@@ -0,0 +1,50 @@
+/*!
+ * @file Wire.h
+ *
+ * @brief Host-side stand-in for the Arduino "Wire" (TwoWire) I2C library
+ *
+ * @section Wire_host_intro_section Description
+ *
+ * Each TwoWire instance is connected to a simulated bus (see "INASim.h"). Writes are buffered
+ * until "endTransmission()" just as on the real hardware, and "requestFrom()" fills a receive
+ * buffer which is then consumed with "read()". The global "Wire" instance is connected to the
+ * default simulated bus.
+ *
+ */
+#ifndef INA_HOST_WIRE_H
+/*! Guard code definition to prevent multiple includes */
+#define INA_HOST_WIRE_H
+#include "Arduino.h"
+
+class SimBus;  // Forward declaration, see INASim.h
+
+class TwoWire {
+  /*!
+   * @class   TwoWire
+   * @brief   I2C master interface which talks to a simulated bus
+   */
+ public:
+  static const uint8_t kBufferLength         = 32;    ///< Buffer size of the AVR implementation
+  static const uint8_t kAlertResponseAddress = 0x0C;  ///< SMBus Alert Response Address
+  explicit TwoWire(SimBus* bus);
+  void    begin();
+  void    setClock(const uint32_t clock);
+  void    beginTransmission(const int address);
+  size_t  write(const uint8_t data);
+  size_t  write(const uint8_t* data, const size_t quantity);
+  uint8_t endTransmission(const uint8_t sendStop = true);
+  uint8_t requestFrom(const int address, const int quantity, const int sendStop = true);
+  int     available() const;
+  int     read();
+  SimBus* bus() const { return _bus; }
+ private:
+  SimBus* _bus;                       ///< Simulated bus this interface is attached to
+  uint8_t _txAddress{0};              ///< Address of the pending write
+  uint8_t _txLength{0};               ///< Number of bytes buffered for writing
+  uint8_t _txBuffer[kBufferLength];   ///< Write buffer
+  uint8_t _rxIndex{0};                ///< Next byte to return from "read()"
+  uint8_t _rxLength{0};               ///< Number of bytes received
+  uint8_t _rxBuffer[kBufferLength];   ///< Read buffer
+};                                    // of class TwoWire
+extern TwoWire Wire;  ///< Global instance, as in the Arduino core
+#endif
@@ -13,6 +13,59 @@
     defined(STM32F1)
   #include <EEPROM.h>  ///< Include the EEPROM library for AVR-Boards
 #endif
+#ifndef IRAM_ATTR
+  #define IRAM_ATTR  ///< Only ESP32 and ESP8266 interrupt handlers need to be placed in IRAM
+#endif
+#if defined(ESP32)
+static portMUX_TYPE pendingLock = portMUX_INITIALIZER_UNLOCKED;  ///< Guards _pendingConversions
+#elif defined(__AVR__)
+typedef uint8_t interruptState;  ///< Status register
+static inline interruptState disableInterrupts() {
+  /*! @brief Disables interrupts and returns the previous state, so it can be used in a handler */
+  uint8_t state = SREG;
+  cli();
+  return state;
+}  // of function disableInterrupts()
+static inline void restoreInterrupts(const interruptState state) {
+  /*! @brief Restores the interrupt state returned by disableInterrupts() */
+  SREG = state;
+}  // of function restoreInterrupts()
+#elif defined(__ARM_ARCH_6M__) || defined(__ARM_ARCH_7M__) || defined(__ARM_ARCH_7EM__) || \
+    defined(__ARM_ARCH_8M_BASE__) || defined(__ARM_ARCH_8M_MAIN__)
+typedef uint32_t interruptState;  ///< PRIMASK register
+static inline interruptState disableInterrupts() {
+  /*! @brief Disables interrupts and returns the previous PRIMASK, see the AVR version above */
+  interruptState state;
+  __asm__ volatile("mrs %0, primask" : "=r"(state));
+  __asm__ volatile("cpsid i" ::: "memory");
+  return state;
+}  // of function disableInterrupts()
+static inline void restoreInterrupts(const interruptState state) {
+  /*! @brief Restores the PRIMASK returned by disableInterrupts() */
+  __asm__ volatile("msr primask, %0" ::"r"(state) : "memory");
+}  // of function restoreInterrupts()
+#elif defined(ESP8266)
+typedef uint32_t interruptState;  ///< Processor state register
+static inline interruptState disableInterrupts() {
+  /*! @brief Disables interrupts and returns the previous level, see the AVR version above */
+  return xt_rsil(15);
+}  // of function disableInterrupts()
+static inline void restoreInterrupts(const interruptState state) {
+  /*! @brief Restores the interrupt level returned by disableInterrupts() */
+  xt_wsr_ps(state);
+}  // of function restoreInterrupts()
+#else
+typedef uint8_t interruptState;  ///< Not used
+static inline interruptState disableInterrupts() {
+  /*! @brief Disables interrupts, the state can't be read so they are always enabled afterwards */
+  noInterrupts();
+  return 0;
+}  // of function disableInterrupts()
+static inline void restoreInterrupts(const interruptState) {
+  /*! @brief Enables interrupts again, see disableInterrupts() */
+  interrupts();
+}  // of function restoreInterrupts()
+#endif
 inaDet::inaDet() {}  ///< constructor for INA Detail class
 inaDet::inaDet(inaEEPROM &inaEE) {
   /*! @brief     INA Detail Class Constructor (Overloaded)
@@ -21,6 +74,9 @@ inaDet::inaDet(inaEEPROM &inaEE) {
   type          = inaEE.type;
   operatingMode = inaEE.operatingMode;
   address       = inaEE.address;
+  bus           = inaEE.bus;
+  muxChannel    = inaEE.muxChannel;
+  busAddress    = (uint16_t)muxChannel << 8 | (bus ? INA_BUS_FLAG : 0) | address;  // Routed address
   maxBusAmps    = inaEE.maxBusAmps;
   microOhmR     = inaEE.microOhmR;
   current_LSB   = (uint64_t)maxBusAmps * 1000000000 / 32767;  // Get the best possible LSB in nA
@@ -44,14 +100,14 @@ inaDet::inaDet(inaEEPROM &inaEE) {
       shuntVoltage_LSB     = INA226_SHUNT_VOLTAGE_LSB;
       break;
 
-    case INA228:
-      power_LSB            = 0;  // TODO
+    case INA228:  // LSBs aren't whole multiples, so the conversion factors are set below
+      current_LSB          = (uint64_t)maxBusAmps * 1000000000 / 524288;  // maxBusAmps / 2^19
+      power_LSB            = current_LSB * 32 / 10;                       // 3.2 * current LSB
       busVoltageRegister   = INA228_BUS_VOLTAGE_REGISTER;
       busVoltage_LSB       = INA228_BUS_VOLTAGE_LSB;
       shuntVoltageRegister = INA228_SHUNT_VOLTAGE_REGISTER;
-
-      currentRegister  = INA226_CURRENT_REGISTER;
-      shuntVoltage_LSB = INA226_SHUNT_VOLTAGE_LSB;
+      currentRegister      = INA228_CURRENT_REGISTER;
+      shuntVoltage_LSB     = 0;
       break;
 
     case INA260:
@@ -83,99 +139,637 @@ inaDet::inaDet(inaEEPROM &inaEE) {
       }                               // of if-then-else INA3221_1
       break;
   }  // of switch type
+  factors = nullptr;  // Convert with divisions until the factors are cached, see "begin()"
+}  // of constructor
+void inaDet::conversionFactor(const uint8_t role, uint64_t &numerator,
+                              uint32_t &denominator) const {
+  /*! @brief     Returns the factor which converts a raw register value of a role
+      @details   The factor is returned as a fraction, so that it is exact for the INA228 and the
+                 INA3221 whose LSBs aren't whole multiples of the result units
+      @param[in] role one of "INA_ROLE_BUS" to "INA_ROLE_POWER", for an INA3221 the power factor
+                 applies to the product of the raw shunt and bus values
+      @param[out] numerator of the factor
+      @param[out] denominator of the factor, 0 if the value isn't available */
+  const bool ina3221 = type == INA3221_0 || type == INA3221_1 || type == INA3221_2;
+  numerator          = 0;
+  denominator        = 0;
+  switch (role) {
+    case INA_ROLE_BUS:
+      numerator   = type == INA228 ? 1953125 : busVoltage_LSB;  // INA228 LSB is 195.3125uV
+      denominator = type == INA228 ? 10000000 : 100;
+      break;
+    case INA_ROLE_SHUNT:
+      if (type == INA228) {  // 78.125nV with ADCRANGE set, otherwise 312.5nV
+        numerator   = 5;
+        denominator = (uint32_t)maxBusAmps * microOhmR <= INA228_LOW_RANGE_MICROVOLTS ? 64 : 16;
+      } else if (type != INA260) {  // No shunt register, see "getShuntMicroVolts()"
+        numerator   = shuntVoltage_LSB;
+        denominator = 10;
+      }  // if-then-else an INA228
+      break;
+    case INA_ROLE_CURRENT:
+      if (type == INA228) {  // maxBusAmps / 2^19 A
+        numerator   = (uint64_t)maxBusAmps * 15625;
+        denominator = 8192;
+      } else if (ina3221) {  // Computed from the shunt voltage
+        numerator   = (uint64_t)shuntVoltage_LSB * 100000;
+        denominator = microOhmR;
+      } else {
+        numerator   = current_LSB;
+        denominator = 1000;
+      }  // if-then-else device family
+      break;
+    case INA_ROLE_POWER:
+      if (type == INA228) {  // 3.2 times the current LSB
+        numerator   = (uint64_t)maxBusAmps * 3125;
+        denominator = 512;
+      } else if (ina3221) {  // Computed from the shunt and bus voltages
+        numerator   = (uint32_t)shuntVoltage_LSB * busVoltage_LSB;
+        denominator = microOhmR;
+      } else {
+        numerator   = power_LSB;
+        denominator = 1000;
+      }  // if-then-else device family
+      break;
+  }  // of switch role
+}  // of method conversionFactor()
+void inaFactors::fixedPoint(const uint8_t role, const uint64_t numerator,
+                            const uint32_t denominator) {
+  /*! @brief     Computes the multiplier and shift pair of a role for "numerator / denominator"
+      @details   The factor is shifted left one bit at a time by long division until the multiplier
+                 reaches 2^62. The multiplier is rounded up, so results are the same as the integer
+                 division they replace for any raw value with raw * numerator below 2^62. Factors
+                 must be below 2^30, so that the shift is at least 32, see "fixedScale()"
+      @param[in] role one of "INA_ROLE_BUS" to "INA_ROLE_POWER"
+      @param[in] numerator of the conversion factor
+      @param[in] denominator of the conversion factor, 0 gives a factor of 0 */
+  shift[role]      = 0;
+  multiplier[role] = 0;
+  if (numerator == 0 || denominator == 0) return;
+  uint64_t remainder = numerator % denominator;
+  uint64_t factor    = numerator / denominator;
+  while (factor < ((uint64_t)1 << 62)) {  // Each step doubles the factor
+    remainder <<= 1;
+    factor <<= 1;
+    if (remainder >= denominator) {
+      remainder -= denominator;
+      factor |= 1;
+    }  // if-then the next quotient bit is set
+    shift[role]++;
+  }  // while the multiplier is below 2^62
+  multiplier[role] = remainder ? factor + 1 : factor;  // Round up
+}  // of method fixedPoint()
+inaConfig::inaConfig(INA_Class &owner, const uint8_t deviceNumber)
+    : _owner(&owner), _deviceNumber(deviceNumber) {
+  /*! @brief     Configuration builder constructor, use "INA_Class::configure()" to get one
+      @param[in] owner instance whose devices are configured
+      @param[in] deviceNumber device to configure, UINT8_MAX for all */
 }  // of constructor
-INA_Class::INA_Class(uint8_t expectedDevices) : _expectedDevices(expectedDevices) {
+inaConfig &inaConfig::mode(const uint8_t mode) {
+  /*! @brief     Sets the operating mode to be written, see "INA_Class::setMode()"
+      @param[in] mode Mode (see "ina_Mode" enumerated type for list of valid values)
+      @return    the builder, for further settings */
+  _mode = mode;
+  bitSet(_settings, INA_SET_MODE);
+  return *this;
+}  // of method mode()
+inaConfig &inaConfig::averaging(const uint16_t averages) {
+  /*! @brief     Sets the hardware averaging to be written, see "INA_Class::setAveraging()"
+      @param[in] averages Number of averages to set (0-1024)
+      @return    the builder, for further settings */
+  _averages = averages;
+  bitSet(_settings, INA_SET_AVERAGING);
+  return *this;
+}  // of method averaging()
+inaConfig &inaConfig::busConv(const uint32_t convTime) {
+  /*! @brief     Sets the bus conversion time to be written, see "INA_Class::setBusConversion()"
+      @param[in] convTime The conversion time in microseconds
+      @return    the builder, for further settings */
+  _busConv = convTime;
+  bitSet(_settings, INA_SET_BUS_CONVERSION);
+  return *this;
+}  // of method busConv()
+inaConfig &inaConfig::shuntConv(const uint32_t convTime) {
+  /*! @brief     Sets the shunt conversion time to be written, see "INA_Class::setShuntConversion()"
+      @param[in] convTime The conversion time in microseconds
+      @return    the builder, for further settings */
+  _shuntConv = convTime;
+  bitSet(_settings, INA_SET_SHUNT_CONVERSION);
+  return *this;
+}  // of method shuntConv()
+uint8_t inaConfig::apply() const {
+  /*! @brief     Writes the settings made to the devices
+      @details   See "INA_Class::configure()"
+      @return    number of configuration registers written */
+  return _owner->applyConfig(*this);
+}  // of method apply()
+INA_Class::INA_Class(uint8_t expectedDevices, const bool cacheDescriptors)
+    : _expectedDevices(expectedDevices), _cacheDescriptors(cacheDescriptors) {
   /*!
 @brief   Class constructor
 @details If called without a parameter or with a 0 value, then the constructor does nothing,
          but if a value is passed then using EEPROM is disabled and each INA-Device found
          has its data (inaEEPROM structure size) stored in a array dynamically allocated during
          library instatiation here. If there is not enough space then the pointer isn't init-
-         ialized and the program will abort later on. No error checking can be done here
+         ialized and the program will abort later on. No error checking can be done here.\n
+         If "cacheDescriptors" is set then "begin()" additionally builds an array of fully resolved
+         "inaDet" structures in RAM. The getters then copy the device's descriptor from that array
+         instead of reading EEPROM and recomputing the LSB values each time the device changes,
+         which costs sizeof(inaDet) and sizeof(inaFactors) bytes of RAM per device. EEPROM is
+         then only accessed when a device's configuration changes. Without the cache the last
+         descriptor used is kept instead. The cache is always built once setBusLock() is used.
 @param[in] expectedDevices Number of elements to initialize array to if non-zero
+@param[in] cacheDescriptors Keep resolved device descriptors in RAM (default false)
 */
   if (_expectedDevices) {
     _DeviceArray = new inaEEPROM[_expectedDevices];
-  }  // if-then use memory rather than EEPROM
+  }                   // if-then use memory rather than EEPROM
+  _wires[0] = &Wire;  // Further buses are added with addBus()
+  for (uint8_t i = 0; i < sizeof(_i2cDelay); i++) {
+    _i2cDelay[i] = I2C_DELAY;
+  }  // for-next each possible device address
 }  // of class constructor
 INA_Class::~INA_Class() {
   /*!
   @brief   Class destructor
   @details If dynamic memory has been allocated for device storage rather than the default EEPROM,
-           then that memory is freed here; otherwise the destructor does nothing
+           then that memory is freed here, as are the descriptor cache, the asynchronous request
+           table, the sample buffer, the integrator states and the frame buffers; a sampling task
+           is stopped first. Otherwise the destructor does nothing
   */
+#if defined(ESP32)
+  stopSamplingTask();  // The task uses everything freed below
+#endif
   if (_expectedDevices) { delete[] _DeviceArray; }  // if-then use memory rather than EEPROM
+  delete[] _DetailArray;                             // deleting nullptr is a no-op
+  delete[] _FactorArray;
+  delete[] _Slots;
+  delete[] _Requests;
+  delete[] _Samples;
+  delete[] _Integrators;
+#if defined(ESP32)
+  delete[] _Frames;
+#endif
 }  // of class destructor
-int16_t INA_Class::readWord(const uint8_t addr, const uint8_t deviceAddress) const {
+int16_t INA_Class::readWord(const uint8_t addr, const uint16_t deviceAddress) const {
   /*! @brief     Read one word (2 bytes) from the specified I2C address
-      @details   Standard I2C protocol is used, but a delay of I2C_DELAY microseconds has been
-                 added to let the INAxxx devices have sufficient time to get the return data ready
+      @details   Standard I2C protocol is used, but a settle delay (I2C_DELAY microseconds unless
+                 changed with setI2CDelay()) is added to let the INAxxx devices have sufficient time
+                 to get the return data ready. The device keeps its register pointer, so if it
+                 already points to "addr" the pointer write and the delay are skipped and only the
+                 read transaction is sent
       @param[in] addr I2C address to read from
       @param[in] deviceAddress Address on the I2C device to read from
       @return    integer value read from the I2C device */
-  Wire.beginTransmission(deviceAddress);        // Address the I2C device
-  Wire.write(addr);                             // Send register address to read
-  Wire.endTransmission();                       // Close transmission
-  delayMicroseconds(I2C_DELAY);                 // delay required for sync
-  Wire.requestFrom(deviceAddress, (uint8_t)2);  // Request 2 consecutive bytes
-  return ((uint16_t)Wire.read() << 8) | Wire.read();
+  TwoWire      &bus     = wire(deviceAddress);               // Bus the device is on
+  const uint8_t address = deviceAddress & INA_ADDRESS_MASK;  // 7 bit I2C address
+  if (!pointerCached(addr, deviceAddress)) {  // Only set the pointer if it has changed
+    bus.beginTransmission(address);           // Address the I2C device
+    bus.write(addr);                          // Send register address to read
+    cachePointer(addr, deviceAddress, bus.endTransmission() == 0);  // Close transmission
+    settle(deviceAddress);                    // delay required for sync
+  }                                           // if-then pointer needs to be written
+  bus.requestFrom(address, (uint8_t)2);       // Request 2 consecutive bytes
+  uint16_t value = ((uint16_t)bus.read() << 8) | bus.read();
+  if (addr == INA_CONFIGURATION_REGISTER) shadowConfig(deviceAddress, value, true, false);
+  return value;
 }  // of method readWord()
-int32_t INA_Class::read3Bytes(const uint8_t addr, const uint8_t deviceAddress) const {
+int32_t INA_Class::read3Bytes(const uint8_t addr, const uint16_t deviceAddress) const {
   /*! @brief     Read 3 bytes from the specified I2C address
-      @details   Standard I2C protocol is used, but a delay of I2C_DELAY microseconds has been
-                 added to let the INAxxx devices have sufficient time to get the return data ready
+      @details   Standard I2C protocol is used, but a settle delay (I2C_DELAY microseconds unless
+                 changed with setI2CDelay()) is added to let the INAxxx devices have sufficient time
+                 to get the return data ready. As in readWord() the pointer write is skipped if the
+                 pointer is already correct
       @param[in] addr I2C address to read from
       @param[in] deviceAddress Address on the I2C device to read from
       @return    integer value read from the I2C device */
-  Wire.beginTransmission(deviceAddress);        // Address the I2C device
-  Wire.write(addr);                             // Send register address to read
-  Wire.endTransmission();                       // Close transmission
-  delayMicroseconds(I2C_DELAY);                 // delay required for sync
-  Wire.requestFrom(deviceAddress, (uint8_t)3);  // Request 3 consecutive bytes
-  return ((uint32_t)Wire.read() << 16) | ((uint32_t)Wire.read() << 8) | ((uint32_t)Wire.read());
+  TwoWire      &bus     = wire(deviceAddress);               // Bus the device is on
+  const uint8_t address = deviceAddress & INA_ADDRESS_MASK;  // 7 bit I2C address
+  if (!pointerCached(addr, deviceAddress)) {  // Only set the pointer if it has changed
+    bus.beginTransmission(address);           // Address the I2C device
+    bus.write(addr);                          // Send register address to read
+    cachePointer(addr, deviceAddress, bus.endTransmission() == 0);  // Close transmission
+    settle(deviceAddress);                    // delay required for sync
+  }                                           // if-then pointer needs to be written
+  bus.requestFrom(address, (uint8_t)3);       // Request 3 consecutive bytes
+  return ((uint32_t)bus.read() << 16) | ((uint32_t)bus.read() << 8) | ((uint32_t)bus.read());
 }  // of method readWord()
+uint64_t INA_Class::read5Bytes(const uint8_t addr, const uint16_t deviceAddress) const {
+  /*! @brief     Read 5 bytes from the specified I2C address
+      @details   Used for the 40 bit INA228 energy and charge accumulators. As in readWord() the
+                 pointer write and settle delay are skipped if the pointer is already correct
+      @param[in] addr I2C address to read from
+      @param[in] deviceAddress Address on the I2C device to read from
+      @return    unsigned 40 bit value read from the I2C device */
+  TwoWire      &bus     = wire(deviceAddress);               // Bus the device is on
+  const uint8_t address = deviceAddress & INA_ADDRESS_MASK;  // 7 bit I2C address
+  if (!pointerCached(addr, deviceAddress)) {  // Only set the pointer if it has changed
+    bus.beginTransmission(address);           // Address the I2C device
+    bus.write(addr);                          // Send register address to read
+    cachePointer(addr, deviceAddress, bus.endTransmission() == 0);  // Close transmission
+    settle(deviceAddress);                    // delay required for sync
+  }                                           // if-then pointer needs to be written
+  bus.requestFrom(address, (uint8_t)5);       // Request 5 consecutive bytes
+  uint64_t value = 0;
+  for (uint8_t i = 0; i < 5; i++) value = (value << 8) | (uint8_t)bus.read();  // MSB first
+  return value;
+}  // of method read5Bytes()
 void INA_Class::writeWord(const uint8_t addr, const uint16_t data,
-                          const uint8_t deviceAddress) const {
+                          const uint16_t deviceAddress) const {
   /*! @brief     Write 2 bytes to the specified I2C address
-      @details   Standard I2C protocol is used, but a delay of I2C_DELAY microseconds has been
-                 added to let the INAxxx devices have sufficient time to process the data
+      @details   Standard I2C protocol is used, but a settle delay (I2C_DELAY microseconds unless
+                 changed with setI2CDelay()) is added to let the INAxxx devices have sufficient time
+                 to process the data
       @param[in] addr I2C address to write to
       @param[in] data 2 Bytes to write to the device
-      @param[in] deviceAddress Address on the I2C device to write to */
-  Wire.beginTransmission(deviceAddress);  // Address the I2C device
-  Wire.write(addr);                       // Send register address to write
-  Wire.write((uint8_t)(data >> 8));       // Write the first (MSB) byte
-  Wire.write((uint8_t)data);              // and then the second byte
-  Wire.endTransmission();                 // Close transmission and actually send data
-  delayMicroseconds(I2C_DELAY);           // delay required for sync
+      @param[in] deviceAddress Address on the I2C device to write to
+      @details   The device's pointer is left at "addr", unless the write failed or reset the device
+                 in which case the cached pointer is invalidated */
+  TwoWire      &bus     = wire(deviceAddress);               // Bus the device is on
+  const uint8_t address = deviceAddress & INA_ADDRESS_MASK;  // 7 bit I2C address
+  bus.beginTransmission(address);             // Address the I2C device
+  bus.write(addr);                            // Send register address to write
+  bus.write((uint8_t)(data >> 8));            // Write the first (MSB) byte
+  bus.write((uint8_t)data);                   // and then the second byte
+  bool written = bus.endTransmission() == 0;  // Close transmission and actually send data
+  bool reset   = addr == INA_CONFIGURATION_REGISTER && (data & INA_RESET_DEVICE);
+  cachePointer(addr, deviceAddress, written && !reset);  // A reset returns the pointer to 0
+  if (addr == INA_CONFIGURATION_REGISTER) {
+    shadowConfig(deviceAddress, data, written && !reset, written);  // Starts a new conversion
+  }  // if-then configuration written
+  if (reset) {
+    for (uint8_t i = 0; i < INA_SHADOWS; i++) shadowRegister(i, deviceAddress, 0, false);
+  }  // if-then all registers back to their reset values
+  settle(deviceAddress);                      // delay required for sync
 }  // of method writeWord()
+void INA_Class::readWords(const uint8_t addr, const uint8_t count, uint16_t *words,
+                          const uint16_t deviceAddress) const {
+  /*! @brief     Read "count" consecutive 2 byte registers starting at the specified I2C address
+      @details   INA devices don't auto-increment the register pointer, so each register is still
+                 addressed separately. All reads are chained with repeated START conditions, with
+                 one STOP for the whole sequence. The settle delay set with setI2CDelay() is still
+                 waited for after each pointer write, unless it is 0
+      @param[in] addr First register address to read from
+      @param[in] count Number of consecutive registers to read
+      @param[out] words Array of at least "count" elements receiving the register values
+      @param[in] deviceAddress Address on the I2C device to read from */
+  TwoWire      &bus     = wire(deviceAddress);               // Bus the device is on
+  const uint8_t address = deviceAddress & INA_ADDRESS_MASK;  // 7 bit I2C address
+  bool          ok      = true;
+  for (uint8_t i = 0; i < count; i++) {
+    bus.beginTransmission(address);                                   // Address the I2C device
+    bus.write((uint8_t)(addr + i));                                   // Send register address
+    ok &= bus.endTransmission(false) == 0;                            // Repeated START follows
+    settle(deviceAddress);                                            // Pointer has to settle
+    bus.requestFrom(address, (uint8_t)2, (uint8_t)(i + 1 == count));  // STOP after last
+    uint16_t msb = bus.read();                                        // MSB is sent first
+    words[i]     = (msb << 8) | bus.read();
+  }                                                   // for-next each register
+  cachePointer(addr + count - 1, deviceAddress, ok);  // Pointer is left at the last register
+}  // of method readWords()
+TwoWire &INA_Class::wire(const uint16_t deviceAddress) const {
+  /*! @brief     Returns the bus a device is on, after selecting its mux channel if necessary
+      @details   The channel is only written to the mux when it isn't already selected, so devices
+                 behind the same channel are read without any additional I2C transactions
+      @param[in] deviceAddress I2C address of the device, see "inaDet::busAddress"
+      @return    Reference to the TwoWire instance */
+  if (deviceAddress >> 8 && !channelSelected(deviceAddress)) {
+    const uint8_t channel = (deviceAddress >> 8) - 1;  // Mux number * 8 + channel
+    for (uint8_t mux = 0; mux < _muxCount; mux++) {
+      if ((_muxes[mux] ^ deviceAddress) & INA_BUS_FLAG) continue;  // Mux is on the other bus
+      writeMux(mux, mux == channel / INA_MUX_CHANNELS ? 1 << (channel % INA_MUX_CHANNELS) : 0);
+    }  // for-next each mux, the others on the bus are switched off
+  }    // if-then device is behind a mux channel not selected
+#if INA_MAX_BUSES > 1
+  if (deviceAddress & INA_BUS_FLAG) return *_wires[1];
+#endif
+  return *_wires[0];
+}  // of method wire()
+void INA_Class::writeMux(const uint8_t mux, const uint8_t channels) const {
+  /*! @brief     Writes the control register of a mux, unless it already has that value
+      @param[in] mux Mux number as returned by addMux()
+      @param[in] channels Bit per channel to switch on, 0 switches all channels off */
+  if (_muxSelected[mux] == channels) return;  // Nothing to change
+  TwoWire &bus = wire(_muxes[mux] & INA_BUS_FLAG);
+  bus.beginTransmission(_muxes[mux] & INA_ADDRESS_MASK);  // Address the mux
+  bus.write(channels);                                    // The only register of the TCA9548A
+  _muxSelected[mux] = bus.endTransmission() == 0 ? channels : INA_MUX_UNKNOWN;
+}  // of method writeMux()
+bool INA_Class::channelSelected(const uint16_t deviceAddress) const {
+  /*! @brief     Returns whether a device can be addressed without writing to a mux first
+      @param[in] deviceAddress I2C address of the device, see "inaDet::busAddress"
+      @return    "true" if the device is directly on the bus or its mux channel is selected */
+  if ((deviceAddress >> 8) == 0) return true;        // Not behind a mux
+  const uint8_t channel = (deviceAddress >> 8) - 1;  // Mux number * 8 + channel
+  return _muxSelected[channel / INA_MUX_CHANNELS] == 1 << (channel % INA_MUX_CHANNELS);
+}  // of method channelSelected()
+uint16_t INA_Class::segmentAddress(const uint8_t segment) const {
+  /*! @brief     Returns the address bits of one bus segment searched by begin()
+      @details   The segments are the buses themselves, followed by every channel of every mux.
+                 begin() numbers the devices in this order, so that a loop over the device numbers
+                 selects each mux channel only once
+      @param[in] segment 0 to _busCount - 1 for the buses, then 8 per mux
+      @return    Value to "or" with an I2C address to get "inaDet::busAddress" */
+  if (segment < _busCount) return segment ? INA_BUS_FLAG : 0;
+  const uint8_t channel = segment - _busCount;  // Mux number * 8 + channel
+  return (uint16_t)(channel + 1) << 8 | (_muxes[channel / INA_MUX_CHANNELS] & INA_BUS_FLAG);
+}  // of method segmentAddress()
+uint16_t INA_Class::probeAddresses(const uint16_t segment) const {
+  /*! @brief     Returns the INA addresses which acknowledge on a bus segment
+      @param[in] segment address bits of the segment, see segmentAddress()
+      @return    Bit per I2C address, bit 0 is INA_FIRST_ADDRESS */
+  uint16_t found = 0;
+  for (uint8_t slot = 0; slot < INA_BUS_SLOTS; slot++) {
+    TwoWire &bus = wire(segment | (INA_FIRST_ADDRESS + slot));
+    bus.beginTransmission(INA_FIRST_ADDRESS + slot);
+    if (bus.endTransmission() == 0) bitSet(found, slot);
+  }  // for-next each possible I2C address
+  return found;
+}  // of method probeAddresses()
+uint8_t INA_Class::addressSlot(const uint16_t deviceAddress) {
+  /*! @brief     Returns the address slot of an I2C address, see "_i2cDelay" and claimSlot()
+      @details   The addresses of the first bus use slots 0 to 15, those of the second bus 16 to 31.
+                 Devices with the same address behind different mux channels share a slot, see
+                 claimSlot()
+      @param[in] deviceAddress I2C address of the device, see "inaDet::busAddress"
+      @return    Slot number or UINT8_MAX if the address isn't one an INA device can have */
+  uint8_t slot = (uint8_t)((deviceAddress & INA_ADDRESS_MASK) - INA_FIRST_ADDRESS);
+  if (slot >= INA_BUS_SLOTS) return UINT8_MAX;
+  return INA_MAX_BUSES > 1 && (deviceAddress & INA_BUS_FLAG) ? slot + INA_BUS_SLOTS : slot;
+}  // of method addressSlot()
+uint8_t INA_Class::slotAddress(const uint8_t slot) {
+  /*! @brief     Returns the I2C address for a slot, the reverse of addressSlot()
+      @param[in] slot Slot number
+      @return    I2C address of the slot, with INA_BUS_FLAG set on the second bus */
+  uint8_t deviceAddress = INA_FIRST_ADDRESS + slot % INA_BUS_SLOTS;
+  return slot >= INA_BUS_SLOTS ? deviceAddress | INA_BUS_FLAG : deviceAddress;
+}  // of method slotAddress()
+void INA_Class::allocateSlots(const inaSlotMask answering) {
+  /*! @brief     Allocates the state kept per I2C address slot for the slots which answered
+      @details   Only the addresses at which something answered during begin() get an entry, so the
+                 RAM used is sizeof(inaSlot) bytes per address rather than per possible address.
+                 Nothing is cached for the other addresses
+      @param[in] answering bit per address slot which answered on a bus or behind a mux channel */
+  uint8_t count = 0;
+  for (inaSlotMask bits = answering; bits; bits &= bits - 1) count++;  // Count the set bits
+  delete[] _Slots;
+  _Slots    = count ? new inaSlot[count]() : nullptr;  // Nothing known about the devices yet
+  _slotMask = _Slots != nullptr ? answering : 0;
+}  // of method allocateSlots()
+inaSlot *INA_Class::claimSlot(const uint16_t deviceAddress) const {
+  /*! @brief     Returns the state of a device's slot, forgetting what is known about another device
+      @details   When the slot was last used for the same address behind another mux channel, the
+                 cached register pointer, shadowed registers and conversion start belong to that
+                 device and are invalidated. The settle delay is kept, it is shared by both devices
+      @param[in] deviceAddress I2C address of the device, see "inaDet::busAddress"
+      @return    Slot state or nullptr if nothing answered at the address in begin(), see
+                 allocateSlots() */
+  const uint8_t slot = addressSlot(deviceAddress);
+  if (slot >= INA_ADDRESS_SLOTS || !bitRead(_slotMask, slot)) return nullptr;
+  uint8_t index = 0;  // Entries are in slot order, so count the slots with one before this
+  for (inaSlotMask below = _slotMask & (((inaSlotMask)1 << slot) - 1); below; below &= below - 1) {
+    index++;
+  }  // for-next each lower slot with an entry
+  inaSlot *entry = &_Slots[index];
+  if (entry->channel != deviceAddress >> 8) {
+    entry->channel      = deviceAddress >> 8;
+    entry->state        = 0;  // Nothing known about the device
+    entry->channelsRead = 0;
+  }  // if-then slot was used by a device behind another mux channel
+  return entry;
+}  // of method claimSlot()
+bool INA_Class::pointerCached(const uint8_t addr, const uint16_t deviceAddress) const {
+  /*! @brief     Returns whether the device's register pointer is known to be set to "addr"
+      @param[in] addr Register address
+      @param[in] deviceAddress I2C address of the device
+      @return    "true" if the pointer write can be skipped */
+  inaSlot *entry = claimSlot(deviceAddress);  // Only INA addresses are cached
+  if (entry == nullptr) return false;
+  return bitRead(entry->state, INA_SLOT_POINTER) && entry->pointer == addr;
+}  // of method pointerCached()
+void INA_Class::cachePointer(const uint8_t addr, const uint16_t deviceAddress,
+                             const bool valid) const {
+  /*! @brief     Remembers the register pointer of a device, or forgets it if "valid" is false
+      @param[in] addr Register address the device now points to
+      @param[in] deviceAddress I2C address of the device
+      @param[in] valid false if the pointer is unknown, e.g. after a reset or a failed write */
+  inaSlot *entry = claimSlot(deviceAddress);  // Only INA addresses are cached
+  if (entry == nullptr) return;
+  entry->pointer = addr;
+  if (valid) {
+    bitSet(entry->state, INA_SLOT_POINTER);
+  } else {
+    bitClear(entry->state, INA_SLOT_POINTER);
+  }  // if-then-else pointer known
+}  // of method cachePointer()
+void INA_Class::shadowConfig(const uint16_t deviceAddress, const uint16_t configRegister,
+                             const bool valid, const bool restarted) const {
+  /*! @brief     Remembers the configuration register of a device after it has been read or written
+      @details   Writing the configuration register aborts the conversion in progress and starts a
+                 new one, so that time is noted as the start of the current conversion cycle
+      @param[in] deviceAddress I2C address of the device
+      @param[in] configRegister value read or written
+      @param[in] valid false if the value is unknown, e.g. after a reset or a failed write
+      @param[in] restarted true if the register was written, starting a new conversion cycle */
+  inaSlot *entry = claimSlot(deviceAddress);  // Only INA addresses are shadowed
+  if (entry == nullptr) return;
+  entry->config = configRegister;
+  if (valid) {
+    bitSet(entry->state, INA_SLOT_CONFIG);
+  } else {
+    bitClear(entry->state, INA_SLOT_CONFIG);
+  }  // if-then-else value known
+  if (restarted) {
+    entry->cycleStart = micros();
+    bitSet(entry->state, INA_SLOT_CYCLE);
+  }  // if-then new conversion cycle
+}  // of method shadowConfig()
+uint16_t INA_Class::currentConfig(const uint16_t deviceAddress) const {
+  /*! @brief     Returns the configuration register of a device
+      @details   The register is only read if its value isn't known from an earlier read or write
+      @param[in] deviceAddress I2C address of the device
+      @return    configuration register value */
+  const inaSlot *entry = claimSlot(deviceAddress);
+  if (entry != nullptr && bitRead(entry->state, INA_SLOT_CONFIG)) {
+    return entry->config;
+  }  // if-then value known
+  return readWord(INA_CONFIGURATION_REGISTER, deviceAddress);  // Also fills the shadow
+}  // of method currentConfig()
+void INA_Class::shadowRegister(const uint8_t shadow, const uint16_t deviceAddress,
+                               const uint16_t value, const bool valid) const {
+  /*! @brief     Remembers the calibration or mask/enable register of a device
+      @details   These registers are at different addresses on the different device types, so
+                 unlike the configuration register they are shadowed by the callers which know the
+                 type rather than by readWord() and writeWord()
+      @param[in] shadow INA_SHADOW_CALIBRATION or INA_SHADOW_MASK
+      @param[in] deviceAddress I2C address of the device
+      @param[in] value value read or written
+      @param[in] valid false if the value is unknown, e.g. after a failed write */
+  inaSlot *entry = claimSlot(deviceAddress);  // Only INA addresses are shadowed
+  if (entry == nullptr) return;
+  entry->shadow[shadow] = value;
+  if (valid) {
+    bitSet(entry->state, INA_SLOT_SHADOW + shadow);
+  } else {
+    bitClear(entry->state, INA_SLOT_SHADOW + shadow);
+  }  // if-then-else value known
+}  // of method shadowRegister()
+uint16_t INA_Class::readShadowed(const uint8_t shadow, const uint8_t addr,
+                                 const uint16_t deviceAddress) const {
+  /*! @brief     Returns a shadowed register, only reading it if its value isn't known
+      @details   Reading the mask/enable register of most devices resets the conversion ready and
+                 alert flags, which is avoided when the shadowed value is used
+      @param[in] shadow INA_SHADOW_CALIBRATION or INA_SHADOW_MASK
+      @param[in] addr register address on this type of device
+      @param[in] deviceAddress I2C address of the device
+      @return    register value */
+  const inaSlot *entry = claimSlot(deviceAddress);
+  if (entry != nullptr && bitRead(entry->state, INA_SLOT_SHADOW + shadow)) {
+    return entry->shadow[shadow];
+  }  // if-then value known
+  uint16_t value = readWord(addr, deviceAddress);
+  shadowRegister(shadow, deviceAddress, value, true);
+  return value;
+}  // of method readShadowed()
+void INA_Class::writeShadowed(const uint8_t shadow, const uint8_t addr, const uint16_t data,
+                              const uint16_t deviceAddress) const {
+  /*! @brief     Writes a shadowed register unless it is known to hold the value already
+      @details   Unlike the configuration register, writing these registers has no side effects
+                 which would be lost by skipping the write
+      @param[in] shadow INA_SHADOW_CALIBRATION or INA_SHADOW_MASK
+      @param[in] addr register address on this type of device
+      @param[in] data value to write
+      @param[in] deviceAddress I2C address of the device */
+  const inaSlot *entry = claimSlot(deviceAddress);
+  if (entry != nullptr && bitRead(entry->state, INA_SLOT_SHADOW + shadow) &&
+      entry->shadow[shadow] == data) {
+    return;
+  }  // if-then value already written
+  writeWord(addr, data, deviceAddress);
+  shadowRegister(shadow, deviceAddress, data, pointerCached(addr, deviceAddress));  // Acknowledged
+}  // of method writeShadowed()
+void INA_Class::retrigger(const inaDet &dev) const {
+  /*! @brief     Starts the next conversion of a device in triggered mode
+      @details   Writing the configuration register starts a conversion. The shadowed value is
+                 written, so the register only has to be read first if its value isn't known
+      @param[in] dev descriptor of the device */
+  writeWord(INA_CONFIGURATION_REGISTER, currentConfig(dev.busAddress), dev.busAddress);  // Trigger
+}  // of method retrigger()
+uint8_t INA_Class::settleMicros(const uint16_t deviceAddress) const {
+  /*! @brief     Returns the settle delay configured for a device
+      @param[in] deviceAddress I2C address of the device
+      @return    Settle delay in microseconds */
+  uint8_t slot = addressSlot(deviceAddress);  // Delays are kept per I2C address
+  return slot < sizeof(_i2cDelay) ? _i2cDelay[slot] : I2C_DELAY;
+}  // of method settleMicros()
+void INA_Class::settle(const uint16_t deviceAddress) const {
+  /*! @brief     Waits for the settle delay configured for a device after a pointer or data write
+      @param[in] deviceAddress I2C address of the device */
+  uint8_t microSeconds = settleMicros(deviceAddress);
+  if (microSeconds) delayMicroseconds(microSeconds);
+}  // of method settle()
+void INA_Class::sleepUntil(const uint32_t wakeAt) const {
+  /*! @brief     Waits until micros() reaches "wakeAt", in short delays with yield() in between so
+                 that other tasks can run
+      @param[in] wakeAt micros() value to wait for, returns at once if it is already in the past */
+  while ((int32_t)(wakeAt - micros()) > 0) {
+    uint32_t remaining = wakeAt - micros();
+    delayMicroseconds(remaining > 1000 ? 1000 : remaining);  // Keep delays short
+    yield();
+  }  // of while waiting
+}  // of method sleepUntil()
 void INA_Class::readInafromEEPROM(const uint8_t deviceNumber) {
   /*! @brief     Read INA device information from EEPROM
-      @details   Retrieve the stored information for a device from EEPROM. Since this method is
-                 private and access is controlled, no range error checking is performed
+      @details   Retrieve the stored information for a device from EEPROM into "ina" for the
+                 methods which change the settings of devices. The read path uses descriptor()
+                 instead. Since this method is private and access is controlled, no range error
+                 checking is performed
       @param[in] deviceNumber Index to device array */
   if (deviceNumber == _currentINA || deviceNumber > _DeviceCount) return;  // Skip if correct device
+  if (_DetailArray != nullptr) {  // Use the resolved descriptor if cached
+    ina         = _DetailArray[deviceNumber];
+    _currentINA = deviceNumber;
+    return;
+  }  // if-then descriptor cached in RAM
+  loadDescriptor(deviceNumber, inaEE);
+  _currentINA = deviceNumber;
+  ina         = inaEE;  // see inaDet constructor
+}  // of method readInafromEEPROM()
+void INA_Class::loadDescriptor(const uint8_t deviceNumber, inaEEPROM &stored) const {
+  /*! @brief     Reads the stored descriptor of a device from EEPROM or from RAM
+      @param[in] deviceNumber Index to device array
+      @param[out] stored receives the descriptor */
   if (_expectedDevices == 0) {
 #if defined(__AVR__) || defined(CORE_TEENSY) || defined(ESP32) || defined(ESP8266) || (__STM32F1__)
-  #ifdef __STM32F1__                                          // STM32F1 has no built-in EEPROM
-    uint16_t  e   = deviceNumber * sizeof(inaEE);             // it uses flash memory to emulate
-    uint16_t *ptr = (uint16_t *)&inaEE;                       // "EEPROM" calls are uint16_t type
-    for (uint8_t n = sizeof(inaEE) + _EEPROM_offset; n; --n)  // Implement EEPROM.get template
+  #ifdef __STM32F1__                                           // STM32F1 has no built-in EEPROM
+    uint16_t  e   = deviceNumber * sizeof(stored);             // it uses flash memory to emulate
+    uint16_t *ptr = (uint16_t *)&stored;                       // "EEPROM" calls are uint16_t type
+    for (uint8_t n = sizeof(stored) + _EEPROM_offset; n; --n)  // Implement EEPROM.get template
     {
       EEPROM.read(e++, ptr++);  // for ina (inaDet type)
     }                           // of for-next each byte
   #else
-    EEPROM.get(_EEPROM_offset + (deviceNumber * sizeof(inaEE)), inaEE);  // Read EEPROM values
+    EEPROM.get(_EEPROM_offset + (deviceNumber * sizeof(stored)), stored);  // Read EEPROM values
   #endif
 #else
-    inaEE                          = _EEPROMEmulation[deviceNumber];
+    stored = _EEPROMEmulation[deviceNumber];
 #endif
   } else {
-    inaEE = _DeviceArray[deviceNumber];
+    stored = _DeviceArray[deviceNumber];
   }  // if-then-else use EEPROM
-  _currentINA = deviceNumber;
-  ina         = inaEE;  // see inaDet constructor
-}  // of method readInafromEEPROM()
+}  // of method loadDescriptor()
+const inaDet *INA_Class::descriptor(const uint8_t deviceNumber, inaDet &scratch) const {
+  /*! @brief     Looks up the resolved descriptor of a device without changing any member
+      @details   The descriptor cache is used directly if there is one, otherwise the stored
+                 descriptor is read and resolved into "scratch", which belongs to the caller. The
+                 last descriptor resolved is kept, so reading one device repeatedly costs no
+                 EEPROM access, just like readInafromEEPROM(). Tasks reading at the same time set
+                 a bus lock, which turns the cache on, so the kept copy is only used by one task,
+                 see setBusLock()
+      @param[in] deviceNumber Index to device array
+      @param[out] scratch caller's storage for the descriptor if it isn't cached
+      @return    Pointer to the descriptor, nullptr if the device number is out of range */
+  if (deviceNumber >= _DeviceCount) return nullptr;
+  if (_DetailArray != nullptr) return &_DetailArray[deviceNumber];  // Resolved in RAM
+  if (deviceNumber == _lastDevice) {
+    scratch = _lastDescriptor;  // Same device as last time, skip the EEPROM read
+    return &scratch;
+  }  // if-then device resolved by the previous call
+  inaEEPROM stored;
+  loadDescriptor(deviceNumber, stored);
+  scratch         = stored;  // see inaDet constructor
+  _lastDescriptor = scratch;
+  _lastDevice     = deviceNumber;
+  return &scratch;
+}  // of method descriptor()
+void INA_Class::cacheFactors(inaDet &dev, inaFactors &factors) {
+  /*! @brief     Computes the fixed-point conversion factors of a cached descriptor
+      @details   Only done when the descriptor cache is built or updated, as the long division of
+                 each factor costs more than the divisions of a single conversion, see scale()
+      @param[in,out] dev cached descriptor, points to "factors" afterwards
+      @param[out] factors receives the multiplier and shift of each register role */
+  uint64_t numerator;
+  uint32_t denominator;
+  for (uint8_t role = INA_ROLE_BUS; role < INA_ROLE_CONFIG; role++) {
+    dev.conversionFactor(role, numerator, denominator);
+    factors.fixedPoint(role, numerator, denominator);
+  }  // for-next each register role
+  dev.factors = &factors;
+}  // of method cacheFactors()
+void INA_Class::lockBus(const uint16_t deviceAddress, const bool lock) const {
+  /*! @brief     Calls the bus lock set with setBusLock(), if any, for the bus of a device
+      @param[in] deviceAddress I2C address of the device, see "inaDet::busAddress"
+      @param[in] lock true to acquire the bus, false to release it */
+  if (_busLock != nullptr) _busLock(deviceAddress & INA_BUS_FLAG ? 1 : 0, lock);
+}  // of method lockBus()
+void INA_Class::lockAllBuses(const bool lock) const {
+  /*! @brief     Calls the bus lock set with setBusLock(), if any, for every bus
+      @details   The buses are acquired in ascending and released in descending order, so two
+                 callers can't each hold a bus the other one is waiting for
+      @param[in] lock true to acquire the buses, false to release them */
+  if (_busLock == nullptr) return;
+  for (uint8_t i = 0; i < _busCount; i++) _busLock(lock ? i : _busCount - 1 - i, lock);
+}  // of method lockAllBuses()
 void INA_Class::writeInatoEEPROM(const uint8_t deviceNumber) {
   /*! @brief     Write INA device information to EEPROM
       @details   Write the stored information for a device from EEPROM. Since this method is
@@ -203,15 +797,161 @@ void INA_Class::writeInatoEEPROM(const uint8_t deviceNumber) {
   } else {
     _DeviceArray[deviceNumber] = inaEE;
   }  // if-then-else use EEPROM to store data
+  if (deviceNumber == _lastDevice) _lastDevice = UINT8_MAX;  // Resolve it again in descriptor()
+  if (_DetailArray != nullptr && deviceNumber < _DeviceCount) {
+    _DetailArray[deviceNumber] = inaEE;  // see inaDet constructor, recomputes the LSB values
+    cacheFactors(_DetailArray[deviceNumber], _FactorArray[deviceNumber]);
+  }  // if-then keep descriptor cache in sync
 }  // of method writeInatoEEPROM()
-void INA_Class::setI2CSpeed(const uint32_t i2cSpeed) const {
+uint8_t INA_Class::addBus(TwoWire &wire) {
+  /*! @brief     Adds another I2C bus to be searched for devices
+      @details   Must be called before begin(). The bus has to be started with its own "begin()"
+                 call (with the pins of that bus) beforehand, begin() only starts "Wire". Devices
+                 on the added bus are numbered after those on "Wire", and each bus can use all the
+                 INA addresses. At most INA_MAX_BUSES buses are supported, which is 1 on AVR
+      @param[in] wire TwoWire instance of the bus, e.g. "Wire1"
+      @return    Bus number to use with setI2CSpeed() and as returned by getDeviceBus(), or
+                 UINT8_MAX if no more buses can be added */
+  if (_DeviceCount || _busCount >= INA_MAX_BUSES) return UINT8_MAX;
+  _wires[_busCount] = &wire;
+  return _busCount++;
+}  // of method addBus()
+uint8_t INA_Class::addMux(const uint8_t muxAddress, const uint8_t bus) {
+  /*! @brief     Adds a TCA9548A (or compatible) I2C multiplexer to be searched for devices
+      @details   Must be called before begin(), and after addBus() for a mux on another bus. begin()
+                 searches every channel of every mux and numbers the devices found channel by
+                 channel, after those connected directly to the buses. Only one channel of the
+                 muxes on a bus is switched on at a time, and the mux is only written to when a
+                 device on another channel is accessed. Loops over the device numbers, triggerAll(),
+                 snapshotAll() and serviceSamples() therefore switch each channel once per pass, and
+                 poll() prefers requests on the channels already selected. Devices behind a mux
+                 may use the same addresses as devices behind other channels, but not those of
+                 devices connected directly to the bus
+      @param[in] muxAddress I2C address of the mux, 0x70 to 0x77
+      @param[in] bus [optional] bus number as returned by addBus(), 0 is "Wire"
+      @return    Mux number, or UINT8_MAX if the address or bus is invalid or no more muxes can be
+                 added */
+  if (_DeviceCount || _muxCount >= INA_MAX_MUXES || bus >= _busCount ||
+      muxAddress < INA_MUX_FIRST_ADDRESS || muxAddress > INA_MUX_LAST_ADDRESS) {
+    return UINT8_MAX;
+  }  // if-then invalid parameters
+  _muxes[_muxCount]       = bus ? muxAddress | INA_BUS_FLAG : muxAddress;
+  _muxSelected[_muxCount] = INA_MUX_UNKNOWN;  // Written on first use
+  return _muxCount++;
+}  // of method addMux()
+void INA_Class::setI2CSpeed(const uint32_t i2cSpeed, const uint8_t bus) const {
   /*! @brief     Set a new I2C speed
       @details   I2C allows various bus speeds, see the enumerated type I2C_MODES for the standard
                  speeds. The valid speeds are  100KHz, 400KHz, 1MHz and 3.4MHz. Default to 100KHz
                  when not specified. No range checking is done.
-      @param[in] i2cSpeed [optional] changes the I2C speed to the rate specified in Herz */
-  Wire.setClock(i2cSpeed);
+      @param[in] i2cSpeed [optional] changes the I2C speed to the rate specified in Herz
+      @param[in] bus [optional] bus number as returned by addBus(), 0 is "Wire". Defaults to all
+                 buses */
+  for (uint8_t i = 0; i < _busCount; i++) {
+    if (bus == UINT8_MAX || bus == i) _wires[i]->setClock(i2cSpeed);
+  }  // for-next each bus
 }  // of method setI2CSpeed
+void INA_Class::setI2CDelay(const uint8_t microSeconds, const uint8_t deviceNumber) {
+  /*! @brief     Set the settle delay used after pointer and data writes
+      @details   The delay defaults to I2C_DELAY microseconds, which was chosen for a 100KHz bus.
+                 At higher bus speeds it is a large part of each register access, so it can be
+                 reduced (down to 0) for all devices or for just one device. Since the delay is
+                 kept per I2C address, all three INA3221 channels share the same value.
+      @param[in] microSeconds Settle delay in microseconds, 0 disables the delay
+      @param[in] deviceNumber [optional] device to set, when not set then all devices are set */
+  for (uint8_t i = 0; i < _DeviceCount; i++)  // Loop for each device found
+  {
+    if (deviceNumber == UINT8_MAX || deviceNumber % _DeviceCount == i)  // If device needs setting
+    {
+      readInafromEEPROM(i);                                   // Load EEPROM to ina structure
+      _i2cDelay[addressSlot(ina.busAddress)] = microSeconds;  // Set delay for this address
+    }  // if-then this device needs to be set
+  }    // for-next each device loop
+}  // of method setI2CDelay()
+void INA_Class::setBusLock(inaBusLock busLock) {
+  /*! @brief     Sets a function which arbitrates the I2C buses between tasks
+      @details   The getters, readAll(), readAllChannels(), conversionFinished() and nextReadyAt()
+                 look the device descriptor up into local storage (see descriptor()) and keep no
+                 other state between calls, so several tasks can read devices at the same time.
+                 Setting a lock turns the descriptor cache on (see the constructor), building it
+                 at once if begin() has already been called, so call this before the tasks start
+                 reading. Only the I2C traffic of each call, together with the register pointer and
+                 configuration knowledge kept per address, has to be serialized per bus.
+                 "busLock" is called with "lock" true before that traffic and false after it,
+                 e.g. to take and give a FreeRTOS mutex per bus. Devices behind muxes share the
+                 mux state of their bus, so the lock has to cover the whole bus. poll() and
+                 serviceSamples() take the lock for each step and each device, triggerAll() and
+                 snapshotAll() take the locks of all buses in ascending order while triggering.
+                 Methods which change settings, begin(), the request and sample buffers
+                 themselves and the integrators are not covered, so startRead(), poll(),
+                 serviceSamples(), readSample() and snapshotAll() must each be called from one
+                 task only. Devices can't be read from an interrupt handler at all, since the
+                 Wire library can't be used there and a lock can't be waited for, see
+                 flagConversion() instead.
+      @param[in] busLock function to call, with the bus number (see getDeviceBus()) and whether to
+                 acquire or release it, or nullptr for none (the default) */
+  _busLock = busLock;
+  if (_busLock != nullptr) buildDescriptorCache();  // Not thread safe without, see descriptor()
+}  // of method setBusLock()
+uint8_t INA_Class::getI2CDelay(const uint8_t deviceNumber) const {
+  /*! @brief     Returns the settle delay in microseconds currently used for a device
+      @param[in] deviceNumber [optional] device to query, defaults to device 0
+      @return    Settle delay in microseconds */
+  if (_DeviceCount == 0) return I2C_DELAY;  // No devices
+  inaDet        scratch;
+  const inaDet *dev = descriptor(deviceNumber % _DeviceCount, scratch);
+  return settleMicros(dev->busAddress);
+}  // of method getI2CDelay()
+uint8_t INA_Class::calibrateI2CDelay(const uint8_t deviceNumber) {
+  /*! @brief     Finds the smallest settle delay which reliably returns stable data
+      @details   For each device the configuration register and a second register holding a
+                 different constant value (the die ID, or the calibration register on devices
+                 without one) are first read with the default I2C_DELAY. Both are then read in
+                 turn with increasing delays starting at 0, so each read follows a pointer write.
+                 A pointer write which hasn't settled returns the other register's data, so the
+                 first delay for which every read returns its own register's value is used from
+                 then on. Call this after begin() and after setting the I2C speed, since the result
+                 depends on the bus. A device whose two registers hold the same value keeps the
+                 default delay.
+      @param[in] deviceNumber [optional] device to calibrate, when not set then all devices are
+                 calibrated
+      @return    The largest delay chosen in microseconds */
+  const uint8_t SAMPLES  = 16;  // Pairs of matching reads required to accept a delay
+  uint8_t       maxDelay = 0;
+  for (uint8_t i = 0; i < _DeviceCount; i++)  // Loop for each device found
+  {
+    if (deviceNumber == UINT8_MAX || deviceNumber % _DeviceCount == i)  // If device needs setting
+    {
+      readInafromEEPROM(i);  // Load EEPROM to ina structure
+      uint8_t slot = addressSlot(ina.busAddress);
+      if (slot >= INA_ADDRESS_SLOTS) continue;  // Not an INA address
+      uint8_t other;  // Register with a constant value other than the configuration
+      switch (ina.type) {
+        case INA219:
+        case INA230:
+        case INA231: other = INA_CALIBRATION_REGISTER; break;
+        case INA228: other = INA228_DIE_ID_REGISTER; break;
+        default: other = INA_DIE_ID_REGISTER;  // INA226, INA260 and INA3221
+      }  // of switch type
+      _i2cDelay[slot] = I2C_DELAY;  // Reference values are read with the default delay
+      cachePointer(INA_CONFIGURATION_REGISTER, ina.busAddress, false);
+      int16_t reference      = readWord(INA_CONFIGURATION_REGISTER, ina.busAddress);
+      int16_t otherReference = readWord(other, ina.busAddress);
+      if (otherReference != reference) {
+        for (_i2cDelay[slot] = 0; _i2cDelay[slot] < I2C_DELAY; _i2cDelay[slot]++) {
+          uint8_t matches = 0;
+          for (; matches < SAMPLES; matches++) {  // The pointer changes with every read
+            if (readWord(INA_CONFIGURATION_REGISTER, ina.busAddress) != reference) break;
+            if (readWord(other, ina.busAddress) != otherReference) break;
+          }                               // for-next each sample
+          if (matches == SAMPLES) break;  // This delay is reliable
+        }                                 // for-next each candidate delay
+      }                                   // if-then registers can be told apart
+      if (_i2cDelay[slot] > maxDelay) maxDelay = _i2cDelay[slot];
+    }  // if-then this device needs to be calibrated
+  }    // for-next each device loop
+  return maxDelay;
+}  // of method calibrateI2CDelay()
 uint8_t INA_Class::begin(const uint16_t maxBusAmps, const uint32_t microOhmR,
                          const uint8_t deviceNumber) {
   /*! @brief     Initializes the contents of the class
@@ -222,6 +962,14 @@ uint8_t INA_Class::begin(const uint16_t maxBusAmps, const uint32_t microOhmR,
                  specified that specific device gets the two specified values set for it. Can be
                  called multiple times, but the 3 parameter version will only function after the 2
                  parameter version finds all devices.\n
+                 Devices are identified by reading their manufacturer and die ID registers, only
+                 devices without these (the INA219) are identified by resetting them and reading
+                 back the configuration register. When the descriptors are kept in EEPROM the
+                 addresses which answered are saved with them, and on the next start (e.g. after a
+                 reset of the microcontroller) the devices found before are only verified with one
+                 register read each, see loadTopology(), instead of being reset and initialized
+                 again. Any difference, including other "maxBusAmps" or "microOhmR" values, leads
+                 to a full search.\n
       @param[in] maxBusAmps Integer value holding the maximum expected bus amperage, this value is
                  used to compute a device's internal power register
       @param[in] microOhmR Shunt resistance in micro-ohms, this value is used to compute a
@@ -230,7 +978,6 @@ uint8_t INA_Class::begin(const uint16_t maxBusAmps, const uint32_t microOhmR,
                  by default all devices found get set to the same initial values for these 2 params
       @return    The integer number of INAxxxx devices found on the I2C bus
   */
-  uint16_t originalRegister, tempRegister;
   if (_DeviceCount == 0)  // Enumerate all devices on first call
   {
     uint16_t maxDevices = 32;
@@ -259,55 +1006,48 @@ uint8_t INA_Class::begin(const uint16_t maxBusAmps, const uint32_t microOhmR,
     {
       maxDevices = 255;
     }  // of if-then more than 255 devices possible
-    for (uint8_t deviceAddress = 0x40; deviceAddress <= 0x4F;
-         deviceAddress++)  // Loop for each I2C addr
-    {
-      Wire.beginTransmission(deviceAddress);
-      uint8_t good = Wire.endTransmission();
-      if (good == 0 && _DeviceCount < maxDevices)  // If no error and EEPROM has space
-      {
-        originalRegister = readWord(INA_CONFIGURATION_REGISTER, deviceAddress);  // Save settings
-        writeWord(INA_CONFIGURATION_REGISTER, INA_RESET_DEVICE, deviceAddress);  // Force reset
-        tempRegister = readWord(INA_CONFIGURATION_REGISTER, deviceAddress);      // Read reset reg.
-        if (tempRegister == INA_RESET_DEVICE)  // If the register wasn't reset then not an INA
+#if defined(__AVR__) || defined(CORE_TEENSY) || defined(ESP32) || defined(ESP8266)
+    if (_expectedDevices == 0) {  // The last slot(s) hold the topology, see saveTopology()
+      maxDevices -= (sizeof(inaTopology) + sizeof(inaEE) - 1) / sizeof(inaEE);
+    }  // if-then use EEPROM
+#endif
+    const uint8_t segments = _busCount + _muxCount * INA_MUX_CHANNELS;  // See segmentAddress()
+    for (uint8_t mux = 0; mux < _muxCount; mux++) writeMux(mux, 0);  // All channels off
+    inaSlotMask responders = 0;  // Bit per I2C address slot which acknowledged
+    inaSlotMask answering  = 0;  // The same, including the addresses behind mux channels
+    uint32_t    channels   = 0;  // Checksum of the addresses answering behind each mux channel
+    for (uint8_t segment = 0; segment < segments; segment++) {
+      const uint16_t segmentBits = segmentAddress(segment);
+      const uint8_t  firstSlot   = segmentBits & INA_BUS_FLAG ? INA_BUS_SLOTS : 0;
+      const uint16_t direct      = responders >> firstSlot;
+      const uint16_t found       = probeAddresses(segmentBits) & ~direct;  // Buses come first
+      if (segment < _busCount) {
+        responders |= (inaSlotMask)found << (segment * INA_BUS_SLOTS);
+      } else {
+        channels = channels * 31 + found;
+      }  // if-then-else bus or mux channel
+      answering |= (inaSlotMask)found << firstSlot;
+    }  // for-next each segment
+    allocateSlots(answering);  // Device pointers and registers are unknown until accessed
+    if (!loadTopology(maxDevices, responders, channels, maxBusAmps, microOhmR)) {
+      for (uint8_t segment = 0; segment < segments; segment++) {
+        const uint16_t segmentBits = segmentAddress(segment);
+        const uint16_t direct      = responders >> (segmentBits & INA_BUS_FLAG ? INA_BUS_SLOTS : 0);
+        const uint16_t found =
+            segment < _busCount ? direct : probeAddresses(segmentBits) & ~direct;
+        for (uint8_t slot = 0; slot < INA_BUS_SLOTS; slot++)  // Loop for each I2C addr
         {
-          writeWord(INA_CONFIGURATION_REGISTER, originalRegister, deviceAddress);  // restore value
-        } else {
-          if (tempRegister == 0x399F) {
-            inaEE.type = INA219;
-          } else {
-            if (tempRegister == 0x4127)  // INA226, INA230, INA231
-            {
-              tempRegister = readWord(INA_DIE_ID_REGISTER, deviceAddress);  // Read the INA high-reg
-              if (tempRegister == INA226_DIE_ID_VALUE) {
-                inaEE.type = INA226;
-              } else {
-                if (tempRegister != 0) {
-                  inaEE.type = INA230;
-                } else {
-                  inaEE.type = INA231;
-                }  // of if-then-else a INA230 or INA231
-              }    // of if-then-else an INA226
-            } else {
-              if (tempRegister == 0x6127) {
-                inaEE.type = INA260;
-              } else {
-                if (tempRegister == 0x7127) {
-                  inaEE.type = INA3221_0;
-                } else {
-                  if (tempRegister == 0x0) {
-                    inaEE.type = INA228;
-                  } else {
-                    inaEE.type = INA_UNKNOWN;
-                  }                       // of if-then-else it is an INA228
-                }                         // of if-then-else it is an INA3221
-              }                           // of if-then-else it is an INA260
-            }                             // of if-then-else it is an INA226, INA230, INA231
-          }                               // of if-then-else it is an INA209, INA219, INA220
+          if (!bitRead(found, slot)) continue;    // Nothing there
+          if (_DeviceCount >= maxDevices) break;  // EEPROM is full
+          const uint16_t deviceAddress = segmentBits | (INA_FIRST_ADDRESS + slot);
+          inaEE.type                   = identifyDevice(deviceAddress);
           if (inaEE.type != INA_UNKNOWN)  // Increment device if valid INA2xx
           {
-            inaEE.address    = deviceAddress;
-            inaEE.maxBusAmps = maxBusAmps > 1022 ? 1022 : maxBusAmps;  // Clamp to maximum of 1022A
+            writeDefaults(inaEE.type, deviceAddress);  // Power-on configuration, without a reset
+            inaEE.address    = deviceAddress & INA_ADDRESS_MASK;
+            inaEE.bus        = (deviceAddress & INA_BUS_FLAG) != 0;
+            inaEE.muxChannel = deviceAddress >> 8;
+            inaEE.maxBusAmps = maxBusAmps > 1022 ? 1022 : maxBusAmps;  // Clamp to maximum 1022A
             inaEE.microOhmR  = microOhmR;
             ina              = inaEE;  // see inaDet constructor
             if (inaEE.type == INA3221_0) {
@@ -325,18 +1065,38 @@ uint8_t INA_Class::begin(const uint16_t maxBusAmps, const uint32_t microOhmR,
               _DeviceCount = ((_DeviceCount + 1) % maxDevices);  // start again at 0 if overflow
             }                                                    // of if-then inaEE.type
           }                                                      // of if-then we can add device
-        }  // of if-then-else we have an INA-Type device
-      }    // of if-then we have a device
-    }      // for-next each possible I2C address
+        }  // for-next each responding I2C address
+      }    // for-next each segment
+      saveTopology(maxDevices, responders, channels);
+    }  // if-then topology has changed
+    if (_cacheDescriptors || _busLock != nullptr) buildDescriptorCache();
   } else {
     readInafromEEPROM(deviceNumber);                         // Load EEPROM to ina structure
     ina.maxBusAmps = maxBusAmps > 1022 ? 1022 : maxBusAmps;  // Clamp to maximum of 1022A
     ina.microOhmR  = microOhmR;
+    inaEE          = ina;
+    ina            = inaEE;  // Recompute the LSB values for the new settings
     initDevice(deviceNumber);
   }                         // of if-then-else first call
   _currentINA = UINT8_MAX;  // Force read on next call
+  _lastDevice = UINT8_MAX;  // and for descriptor() as well
   return _DeviceCount;
 }  // of method begin()
+void INA_Class::buildDescriptorCache() {
+  /*! @brief     Resolves the descriptor of every device found into "_DetailArray"
+      @details   See the constructor's "cacheDescriptors" parameter and setBusLock(). Does nothing
+                 if the cache already exists or no devices have been found */
+  if (_DetailArray != nullptr || _DeviceCount == 0) return;
+  inaDet *details = new inaDet[_DeviceCount];  // Resolve every descriptor once
+  _FactorArray    = new inaFactors[_DeviceCount];
+  for (uint8_t i = 0; i < _DeviceCount; i++) {
+    readInafromEEPROM(i);  // Load EEPROM to ina structure
+    details[i] = ina;
+    cacheFactors(details[i], _FactorArray[i]);
+  }                          // for-next each device
+  _DetailArray = details;    // From now on getters use the cached descriptors
+  _currentINA  = UINT8_MAX;  // "ina" has no factors, reload it from the cache
+}  // of method buildDescriptorCache()
 void INA_Class::initDevice(const uint8_t deviceNumber) {
   /*! @brief     Initializes the the given devices using the settings from the internal structure
       @details   This includes (re)computing the device's calibration values.
@@ -344,13 +1104,11 @@ void INA_Class::initDevice(const uint8_t deviceNumber) {
   ina.operatingMode = INA_DEFAULT_OPERATING_MODE;  // Default to continuous mode
   writeInatoEEPROM(deviceNumber);                  // Store the structure to EEPROM
   uint8_t  programmableGain;                       // work variable for the programmable gain
-  uint16_t calibration, maxShuntmV, tempRegister;  // Calibration temporary variables
+  uint16_t maxShuntmV, tempRegister, oldRegister;  // Calibration temporary variables
   switch (ina.type) {
     case INA219:  // Set up INA219 or INA220
-      // Compute calibration register
-      calibration = (uint64_t)409600000 /
-                    ((uint64_t)ina.current_LSB * (uint64_t)ina.microOhmR / (uint64_t)100000);
-      writeWord(INA_CALIBRATION_REGISTER, calibration, ina.address);  // Write calibration
+      writeShadowed(INA_SHADOW_CALIBRATION, INA_CALIBRATION_REGISTER, calibrationValue(),
+                    ina.busAddress);  // Write calibration
       /* Determine optimal programmable gain with maximum accuracy so no chance of an overflow */
       maxShuntmV = ina.maxBusAmps * ina.microOhmR / 1000;  // Compute maximum shunt mV
       if (maxShuntmV <= 40)
@@ -361,18 +1119,33 @@ void INA_Class::initDevice(const uint8_t deviceNumber) {
         programmableGain = 2;  // gain x4 for +- 160mV
       else
         programmableGain = 3;                                   // dflt gain x8 for +- 320mV
-      tempRegister = 0x399F & INA219_CONFIG_PG_MASK;            // Zero programmable gain
+      tempRegister = INA219_CONFIG_DEFAULT & INA219_CONFIG_PG_MASK;  // Zero programmable gain
       tempRegister |= programmableGain << INA219_PG_FIRST_BIT;  // Overwrite the new values
       bitSet(tempRegister, INA219_BRNG_BIT);                    // set to 1 for 0-32 volts
-      writeWord(INA_CONFIGURATION_REGISTER, tempRegister, ina.address);  // Write to config register
+      if ((uint16_t)currentConfig(ina.busAddress) != tempRegister) {
+        writeWord(INA_CONFIGURATION_REGISTER, tempRegister, ina.busAddress);  // Write config
+      }  // if-then gain or range changed
       break;
     case INA226:
     case INA230:
     case INA231:
-      // Compute calibration register
-      calibration = (uint64_t)51200000 /
-                    ((uint64_t)ina.current_LSB * (uint64_t)ina.microOhmR / (uint64_t)100000);
-      writeWord(INA_CALIBRATION_REGISTER, calibration, ina.address);  // Write calibration
+      writeShadowed(INA_SHADOW_CALIBRATION, INA_CALIBRATION_REGISTER, calibrationValue(),
+                    ina.busAddress);  // Write calibration
+      break;
+    case INA228:
+      // Use the +-40.96mV range with 4 times the resolution if the shunt voltage stays within it
+      oldRegister  = currentConfig(ina.busAddress);  // Get current value
+      tempRegister = oldRegister;
+      bitClear(tempRegister, INA228_ADCRANGE_BIT);
+      if ((uint32_t)ina.maxBusAmps * ina.microOhmR <= INA228_LOW_RANGE_MICROVOLTS) {
+        bitSet(tempRegister, INA228_ADCRANGE_BIT);
+      }  // if-then the smaller range is enough
+      if (tempRegister != oldRegister) {
+        writeWord(INA_CONFIGURATION_REGISTER, tempRegister, ina.busAddress);  // Write ADCRANGE
+      }  // if-then range changed
+      writeShadowed(INA_SHADOW_CALIBRATION, INA228_SHUNT_CAL_REGISTER, calibrationValue(),
+                    ina.busAddress);  // Calibrate
+      clearAccumulators(ina);  // Accumulated with the old calibration
       break;
     case INA260:
     case INA3221_0:
@@ -380,175 +1153,321 @@ void INA_Class::initDevice(const uint8_t deviceNumber) {
     case INA3221_2: break;
   }  // of switch type
 }  // of method initDevice()
+void INA_Class::writeDefaults(const uint8_t type, const uint16_t deviceAddress) {
+  /*! @brief     Sets the configuration of a device found by begin() to its power-on value
+      @details   Unlike a reset, this leaves a device which already has that configuration alone, so
+                 its conversion in progress isn't aborted. The calibration is written by
+                 initDevice(), other registers such as the alert settings are kept
+      @param[in] type device type, see "ina_Type"
+      @param[in] deviceAddress I2C address of the device */
+  uint16_t defaults;  // Configuration register value after a reset
+  switch (type) {
+    case INA219: defaults = INA219_CONFIG_DEFAULT; break;
+    case INA228:
+      if ((uint16_t)readWord(INA228_ADC_CONFIG_REGISTER, deviceAddress) !=
+          INA228_ADC_CONFIG_DEFAULT) {
+        writeWord(INA228_ADC_CONFIG_REGISTER, INA228_ADC_CONFIG_DEFAULT, deviceAddress);
+      }  // if-then ADC configuration changed
+      defaults = 0;
+      break;
+    case INA260: defaults = INA260_CONFIG_DEFAULT; break;
+    case INA3221_0: defaults = INA3221_CONFIG_DEFAULT; break;
+    default: defaults = INA226_CONFIG_DEFAULT;  // INA226, INA230 and INA231
+  }  // of switch type
+  if ((uint16_t)currentConfig(deviceAddress) != defaults) {
+    writeWord(INA_CONFIGURATION_REGISTER, defaults, deviceAddress);
+  }  // if-then configuration changed
+}  // of method writeDefaults()
+uint16_t INA_Class::calibrationValue() const {
+  /*! @brief     Returns the calibration register value for the device in "ina"
+      @details   INA228 SHUNT_CAL is 13107.2E6 * current LSB * shunt ohms with a current LSB of
+                 maxBusAmps / 2^19, multiplied by 4 if the +-40.96mV range (ADCRANGE) is used
+      @return    value written to the calibration register, 0 for devices without one */
+  uint32_t calibration = 0;
+  switch (ina.type) {
+    case INA219:
+      calibration = (uint64_t)409600000 /
+                    ((uint64_t)ina.current_LSB * (uint64_t)ina.microOhmR / (uint64_t)100000);
+      break;
+    case INA226:
+    case INA230:
+    case INA231:
+      calibration = (uint64_t)51200000 /
+                    ((uint64_t)ina.current_LSB * (uint64_t)ina.microOhmR / (uint64_t)100000);
+      break;
+    case INA228:
+      calibration = (uint32_t)ina.maxBusAmps * ina.microOhmR / 40;
+      if ((uint32_t)ina.maxBusAmps * ina.microOhmR <= INA228_LOW_RANGE_MICROVOLTS) {
+        calibration *= 4;  // SHUNT_CAL is multiplied by 4 in this range
+      }                    // if-then the smaller range is used
+      break;
+    default: break;
+  }  // of switch type
+  return calibration;
+}  // of method calibrationValue()
+uint8_t INA_Class::identifyDevice(const uint16_t deviceAddress) {
+  /*! @brief     Returns the type of the device at an I2C address
+      @details   The manufacturer and die ID registers are read first, which doesn't disturb a
+                 device that is measuring. Only if these don't identify the device (the INA219,
+                 INA230 and INA231 have neither) is it reset and identified by the reset value of
+                 its configuration register. Should the reset bit still be set afterwards it is
+                 not an INA device and the original value is written back
+      @param[in] deviceAddress I2C address of the device
+      @return    Type of device, see "ina_Type", or INA_UNKNOWN */
+  if ((uint16_t)readWord(INA_MANUFACTURER_ID_REGISTER, deviceAddress) == INA_MANUFACTURER_ID) {
+    switch ((uint16_t)readWord(INA_DIE_ID_REGISTER, deviceAddress)) {
+      case INA226_DIE_ID_VALUE: return INA226;
+      case INA260_DIE_ID_VALUE: return INA260;
+      case INA3221_DIE_ID_VALUE: return INA3221_0;
+      default: break;  // Not known, identified by its configuration register below
+    }                  // of switch die ID
+  }                    // if-then manufacturer ID found
+  if ((uint16_t)readWord(INA228_MANUFACTURER_ID_REGISTER, deviceAddress) == INA_MANUFACTURER_ID &&
+      ((uint16_t)readWord(INA228_DIE_ID_REGISTER, deviceAddress) & INA228_DIE_ID_MASK) ==
+          INA228_DIE_ID_VALUE) {
+    return INA228;
+  }  // if-then INA228 manufacturer and die ID found
+  uint16_t originalRegister = readWord(INA_CONFIGURATION_REGISTER, deviceAddress);  // Save it
+  writeWord(INA_CONFIGURATION_REGISTER, INA_RESET_DEVICE, deviceAddress);           // Force reset
+  uint16_t tempRegister = readWord(INA_CONFIGURATION_REGISTER, deviceAddress);  // Read reset reg.
+  if (tempRegister == INA_RESET_DEVICE)  // If the register wasn't reset then not an INA
+  {
+    writeWord(INA_CONFIGURATION_REGISTER, originalRegister, deviceAddress);  // restore value
+    return INA_UNKNOWN;
+  }  // if-then not an INA
+  if (tempRegister == INA219_CONFIG_DEFAULT) return INA219;
+  if (tempRegister == INA226_CONFIG_DEFAULT)  // INA226, INA230, INA231
+  {
+    tempRegister = readWord(INA_DIE_ID_REGISTER, deviceAddress);  // Read the INA high-reg
+    if (tempRegister == INA226_DIE_ID_VALUE) return INA226;
+    return tempRegister != 0 ? INA230 : INA231;
+  }  // of if-then an INA226, INA230 or INA231
+  if (tempRegister == INA260_CONFIG_DEFAULT) return INA260;
+  if (tempRegister == INA3221_CONFIG_DEFAULT) return INA3221_0;
+  if (tempRegister == 0x0) return INA228;
+  return INA_UNKNOWN;
+}  // of method identifyDevice()
+bool INA_Class::loadTopology(const uint8_t maxDevices, const inaSlotMask responders,
+                             const uint32_t channels, const uint16_t maxBusAmps,
+                             const uint32_t microOhmR) {
+  /*! @brief     Restores the devices found by the previous begin() if nothing has changed
+      @details   The topology record saved by saveTopology() has to list the same addresses as
+                 those answering now, and every descriptor has to match the "maxBusAmps" and
+                 "microOhmR" values given. Each device is then verified with one register read:
+                 the calibration register on devices which have one, which also shows that the
+                 device hasn't been power cycled, otherwise the configuration register, whose
+                 operating mode has to match the descriptor. No register is written
+      @param[in] maxDevices number of descriptors which fit into EEPROM
+      @param[in] responders bit per I2C address slot which answered
+      @param[in] channels checksum of the addresses answering behind each mux channel
+      @param[in] maxBusAmps value given to begin()
+      @param[in] microOhmR value given to begin()
+      @return    "true" if the devices have been restored and don't need to be initialized */
+#if defined(__AVR__) || defined(CORE_TEENSY) || defined(ESP32) || defined(ESP8266)
+  if (_expectedDevices) return false;  // Descriptors are in RAM and lost on a reset
+  inaTopology topology;
+  EEPROM.get(_EEPROM_offset + maxDevices * sizeof(inaEE), topology);
+  if (topology.signature != INA_TOPOLOGY_SIGNATURE || topology.responders != responders ||
+      topology.channels != channels || topology.devices == 0 || topology.devices > maxDevices) {
+    return false;
+  }  // if-then no valid record or other addresses answering
+  _DeviceCount = topology.devices;  // So that the descriptors can be read
+  bool valid   = true;
+  for (uint8_t i = 0; i < _DeviceCount && valid; i++) {
+    readInafromEEPROM(i);  // Load EEPROM to ina structure
+    valid = ina.type < INA_UNKNOWN && ina.address >= INA_FIRST_ADDRESS &&
+            ina.address <= INA_LAST_ADDRESS &&
+            (ina.muxChannel ? ina.muxChannel <= _muxCount * INA_MUX_CHANNELS
+                            : bitRead(responders, addressSlot(ina.busAddress))) &&
+            ina.maxBusAmps == (maxBusAmps > 1022 ? 1022 : maxBusAmps) &&
+            ina.microOhmR == (microOhmR & 0xFFFFF);  // Stored in 20 bits
+    if (!valid || ina.type == INA3221_1 || ina.type == INA3221_2) continue;  // Package checked
+    uint16_t calibration = calibrationValue();
+    if (calibration) {
+      uint8_t calibrationRegister =
+          ina.type == INA228 ? INA228_SHUNT_CAL_REGISTER : INA_CALIBRATION_REGISTER;
+      uint16_t implemented = ina.type == INA219 ? 0xFFFE : 0x7FFF;  // Other bits read as 0
+      valid = (((uint16_t)readWord(calibrationRegister, ina.busAddress) ^ calibration) &
+               implemented) == 0;
+      shadowRegister(INA_SHADOW_CALIBRATION, ina.busAddress, calibration, valid);
+    } else {
+      valid = ((uint16_t)readWord(INA_CONFIGURATION_REGISTER, ina.busAddress) &
+               INA_CONFIG_MODE_MASK) == ina.operatingMode;
+    }  // if-then-else device has a calibration register
+  }    // for-next each device
+  _currentINA = UINT8_MAX;  // Force read on next call
+  if (!valid) _DeviceCount = 0;
+  return valid;
+#else
+  (void)maxDevices;  // No EEPROM to keep the topology in
+  (void)responders;
+  (void)channels;
+  (void)maxBusAmps;
+  (void)microOhmR;
+  return false;
+#endif
+}  // of method loadTopology()
+void INA_Class::saveTopology(const uint8_t maxDevices, const inaSlotMask responders,
+                             const uint32_t channels) const {
+  /*! @brief     Saves the addresses which answered and the number of devices found
+      @details   The record is kept in the EEPROM space just after the last possible descriptor
+                 and is used by loadTopology() on the next start. Nothing is saved if the
+                 descriptors aren't kept in EEPROM
+      @param[in] maxDevices number of descriptors which fit into EEPROM
+      @param[in] responders bit per I2C address slot which answered
+      @param[in] channels checksum of the addresses answering behind each mux channel */
+#if defined(__AVR__) || defined(CORE_TEENSY) || defined(ESP32) || defined(ESP8266)
+  if (_expectedDevices) return;  // Descriptors are in RAM and lost on a reset
+  inaTopology topology;
+  topology.signature  = _DeviceCount ? INA_TOPOLOGY_SIGNATURE : 0;  // Search again if none found
+  topology.responders = responders;
+  topology.channels   = channels;
+  topology.devices    = _DeviceCount;
+  EEPROM.put(_EEPROM_offset + maxDevices * sizeof(inaEE), topology);
+  #ifdef ESP32
+  EEPROM.commit();  // Force write to EEPROM when ESP32
+  #endif
+#else
+  (void)maxDevices;  // No EEPROM to keep the topology in
+  (void)responders;
+  (void)channels;
+#endif
+}  // of method saveTopology()
 void INA_Class::setBusConversion(const uint32_t convTime, const uint8_t deviceNumber) {
   /*! @brief     specifies the conversion rate in microseconds, rounded to the nearest valid value
-      @details   INA devices can have a conversion rate of up to 68100 microseconds
+      @details   INA devices can have a conversion rate of up to 68100 microseconds. To change
+                 several settings with one register write use configure() instead
       @param[in] convTime The conversion time in microseconds, invalid values are rounded to the
                  nearest valid value
       @param[in] deviceNumber [optional] When specified, only that specified device number gets
                  changed, otherwise all devices are set to the same averaging rate
   */
-  uint16_t configRegister;
-  int16_t  convRate;
-  for (uint8_t i = 0; i < _DeviceCount; i++)  // Loop for each device found
-  {
-    if (deviceNumber == UINT8_MAX || deviceNumber % _DeviceCount == i)  // If device needs setting
-    {
-      readInafromEEPROM(i);  // Load EEPROM values to ina structure
-      configRegister = readWord(INA_CONFIGURATION_REGISTER, ina.address);  // Get current register
-      switch (ina.type) {
-        case INA219:
-          if (convTime >= 68100)
-            convRate = 15;
-          else if (convTime >= 34050)
-            convRate = 14;
-          else if (convTime >= 17020)
-            convRate = 13;
-          else if (convTime >= 8510)
-            convRate = 12;
-          else if (convTime >= 4260)
-            convRate = 11;
-          else if (convTime >= 2130)
-            convRate = 10;
-          else if (convTime >= 1060)
-            convRate = 9;
-          else if (convTime >= 532)
-            convRate = 8;
-          else if (convTime >= 276)
-            convRate = 2;
-          else if (convTime >= 148)
-            convRate = 1;
-          else
-            convRate = 0;
-          configRegister &= ~INA219_CONFIG_BADC_MASK;  // zero out the averages part
-          configRegister |= convRate << 7;             // shift in the BADC averages
-          break;
-        case INA226:
-        case INA230:
-        case INA231:
-        case INA3221_0:
-        case INA3221_1:
-        case INA3221_2:
-        case INA260:
-          if (convTime >= 8244)
-            convRate = 7;
-          else if (convTime >= 4156)
-            convRate = 6;
-          else if (convTime >= 2116)
-            convRate = 5;
-          else if (convTime >= 1100)
-            convRate = 4;
-          else if (convTime >= 588)
-            convRate = 3;
-          else if (convTime >= 332)
-            convRate = 2;
-          else if (convTime >= 204)
-            convRate = 1;
-          else
-            convRate = 0;
-          if (ina.type == INA226 || ina.type == INA3221_0 || ina.type == INA3221_1 ||
-              ina.type == INA3221_2) {
-            configRegister &= ~INA226_CONFIG_BADC_MASK;  // zero out the averages part
-            configRegister |= convRate << 6;             // shift in averages
-          } else {
-            configRegister &= ~INA260_CONFIG_BADC_MASK;  // zero out the averages part
-            configRegister |= convRate << 7;             // shift in the averages
-          }                                              // of if-then an INA226 or INA260
-          break;
-      }  // of switch type
-      writeWord(INA_CONFIGURATION_REGISTER, configRegister,
-                ina.address);  // Save new value to device
-    }                          // of if this device needs to be set
-  }                            // for-next each device loop
+  configure(deviceNumber).busConv(convTime).apply();
 }  // of method setBusConversion()
 void INA_Class::setShuntConversion(const uint32_t convTime, const uint8_t deviceNumber) {
   /*! @brief     specifies the conversion rate in microseconds, rounded to the nearest valid value
-      @details   INA devices can have a conversion rate of up to 68100 microseconds
+      @details   INA devices can have a conversion rate of up to 68100 microseconds. To change
+                 several settings with one register write use configure() instead
       @param[in] convTime Conversion time in microseconds. Out-of-Range values are set to the
                  closest valid value
       @param[in] deviceNumber to return the device name for[optional] When specified, only that
                  specified device number gets changed, otherwise all devices are set to the same
                  averaging rate
                  */
-  int16_t configRegister, convRate;
-  for (uint8_t i = 0; i < _DeviceCount; i++) {  // Loop for each device found
-    if (deviceNumber == UINT8_MAX ||
-        deviceNumber % _DeviceCount == i)  // If this device needs setting
-    {
-      readInafromEEPROM(i);  // Load EEPROM to ina structure
-      configRegister = readWord(INA_CONFIGURATION_REGISTER, ina.address);  // Get register contents
-      switch (ina.type) {
-        case INA219:
-          if (convTime >= 68100)
-            convRate = 15;
-          else if (convTime >= 34050)
-            convRate = 14;
-          else if (convTime >= 17020)
-            convRate = 13;
-          else if (convTime >= 8510)
-            convRate = 12;
-          else if (convTime >= 4260)
-            convRate = 11;
-          else if (convTime >= 2130)
-            convRate = 10;
-          else if (convTime >= 1060)
-            convRate = 9;
-          else if (convTime >= 532)
-            convRate = 8;
-          else if (convTime >= 276)
-            convRate = 2;
-          else if (convTime >= 148)
-            convRate = 1;
-          else
-            convRate = 0;
-          configRegister &= ~INA219_CONFIG_SADC_MASK;  // zero out the averages part
-          configRegister |= convRate << 3;             // shift in the SADC averages
-          break;
-        case INA226:
-        case INA230:
-        case INA231:
-        case INA3221_0:
-        case INA3221_1:
-        case INA3221_2:
-        case INA260:
-          if (convTime >= 8244)
-            convRate = 7;
-          else if (convTime >= 4156)
-            convRate = 6;
-          else if (convTime >= 2116)
-            convRate = 5;
-          else if (convTime >= 1100)
-            convRate = 4;
-          else if (convTime >= 588)
-            convRate = 3;
-          else if (convTime >= 332)
-            convRate = 2;
-          else if (convTime >= 204)
-            convRate = 1;
-          else
-            convRate = 0;
-          if (ina.type == INA226 || ina.type == INA3221_0 || ina.type == INA3221_1 ||
-              ina.type == INA3221_2) {
-            configRegister &= ~INA226_CONFIG_SADC_MASK;  // zero out the averages part
-          } else {
-            configRegister &= ~INA260_CONFIG_SADC_MASK;  // zero out the averages part
-          }                                 // of if-then-else either INA226/INA3221 or a INA260
-          configRegister |= convRate << 3;  // shift in the averages to register
-          break;
-      }  // of switch type
-      writeWord(INA_CONFIGURATION_REGISTER, configRegister,
-                ina.address);  // Save new value to device
-    }                          // of if this device needs to be set
-  }                            // for-next each device loop
+  configure(deviceNumber).shuntConv(convTime).apply();
 }  // of method setShuntConversion()
-const char *INA_Class::getDeviceName(const uint8_t deviceNumber) {
+inaConfig INA_Class::configure(const uint8_t deviceNumber) {
+  /*!
+  @brief     Returns a builder to change several configuration settings with one register write
+  @details   The settings are collected with mode(), averaging(), busConv() and shuntConv(), which
+             take the same values as setMode(), setAveraging(), setBusConversion() and
+             setShuntConversion(). apply() then computes each device's new configuration register
+             from its shadowed value and writes it once, e.g.\n
+             INA.configure().mode(INA_MODE_CONTINUOUS_BOTH).averaging(16).busConv(1100).apply();\n
+             The register is only read if its value isn't known from an earlier read or write, and
+             an INA3221 is written once for all 3 of its channels. Settings not made are left as
+             they are. On the INA219 averaging and conversion times share the ADC fields, so
+             conversion times given together with averaging take precedence
+  @param[in] deviceNumber to configure (Optional, when not set all devices are configured)
+  @return    builder for the settings
+  */
+  return inaConfig(*this, deviceNumber);
+}  // of method configure()
+uint8_t INA_Class::applyConfig(const inaConfig &config) {
+  /*! @brief     Writes the settings of a builder to the devices, see configure()
+      @param[in] config settings to write
+      @return    number of configuration registers written */
+  uint8_t  written     = 0;
+  uint16_t lastAddress = UINT16_MAX;  // The channels of an INA3221 are numbered consecutively
+  for (uint8_t i = 0; i < _DeviceCount; i++) {  // Loop for each device found
+    if (config._deviceNumber != UINT8_MAX && config._deviceNumber % _DeviceCount != i) continue;
+    readInafromEEPROM(i);  // Load EEPROM to ina structure
+    if (bitRead(config._settings, INA_SET_MODE) &&
+        ina.operatingMode != (config._mode & INA_CONFIG_MODE_MASK)) {
+      ina.operatingMode = config._mode & INA_CONFIG_MODE_MASK;  // Mask off unused bits
+      writeInatoEEPROM(i);                                      // Store back to EEPROM
+    }  // if-then mode changed
+    if (ina.busAddress == lastAddress) continue;  // Package already written
+    lastAddress = ina.busAddress;
+    writeWord(INA_CONFIGURATION_REGISTER,
+              configValue(ina.type, currentConfig(ina.busAddress), config), ina.busAddress);
+    written++;
+  }  // for-next each device
+  return written;
+}  // of method applyConfig()
+uint16_t INA_Class::configValue(const uint8_t type, uint16_t configRegister,
+                                const inaConfig &config) {
+  /*! @brief     Returns a configuration register value with the settings of a builder applied
+      @details   Averaging and conversion times are rounded down to the next valid value, values
+                 below the smallest valid value select it
+      @param[in] type device type, see "ina_Type"
+      @param[in] configRegister current configuration register value
+      @param[in] config settings to apply
+      @return    new configuration register value */
+  static const uint32_t ina219Times[11]    = {0,    148,  276,   532,   1060, 2130,
+                                              4260, 8510, 17020, 34050, 68100};
+  static const uint16_t ina219Averages[8]  = {0, 2, 4, 8, 16, 32, 64, 128};
+  static const uint16_t conversionTimes[8] = {0, 204, 332, 588, 1100, 2116, 4156, 8244};
+  static const uint16_t averages[8]        = {0, 4, 16, 64, 128, 256, 512, 1024};
+  uint8_t               code;
+  if (bitRead(config._settings, INA_SET_MODE)) {
+    configRegister &= ~INA_CONFIG_MODE_MASK;                // zero out  mode bits
+    configRegister |= config._mode & INA_CONFIG_MODE_MASK;  // shift mode settings
+  }  // if-then set mode
+  switch (type) {
+    case INA219:  // Codes 8-15 average 1-128 samples, codes 0-2 and 8 are single conversions
+      if (bitRead(config._settings, INA_SET_AVERAGING)) {
+        for (code = 7; ina219Averages[code] > config._averages; code--) {}
+        configRegister &= ~INA219_CONFIG_AVG_MASK;  // zero out the averages part
+        configRegister |= (code + 8) << 3;          // shift in the SADC averages
+        configRegister |= (code + 8) << 7;          // shift in the BADC averages
+      }  // if-then set averaging
+      if (bitRead(config._settings, INA_SET_BUS_CONVERSION)) {
+        for (code = 10; ina219Times[code] > config._busConv; code--) {}
+        configRegister &= ~INA219_CONFIG_BADC_MASK;           // zero out the conversion part
+        configRegister |= (code < 3 ? code : code + 5) << 7;  // shift in the BADC code
+      }  // if-then set bus conversion time
+      if (bitRead(config._settings, INA_SET_SHUNT_CONVERSION)) {
+        for (code = 10; ina219Times[code] > config._shuntConv; code--) {}
+        configRegister &= ~INA219_CONFIG_SADC_MASK;           // zero out the conversion part
+        configRegister |= (code < 3 ? code : code + 5) << 3;  // shift in the SADC code
+      }  // if-then set shunt conversion time
+      break;
+    case INA226:
+    case INA230:
+    case INA231:
+    case INA3221_0:
+    case INA3221_1:
+    case INA3221_2:
+    case INA260:
+      if (bitRead(config._settings, INA_SET_AVERAGING)) {
+        for (code = 7; averages[code] > config._averages; code--) {}
+        configRegister &= ~INA226_CONFIG_AVG_MASK;  // zero out the averages part
+        configRegister |= code << 9;                // shift in the averages to reg
+      }  // if-then set averaging
+      if (bitRead(config._settings, INA_SET_BUS_CONVERSION)) {
+        for (code = 7; conversionTimes[code] > config._busConv; code--) {}
+        configRegister &= ~INA226_CONFIG_BADC_MASK;  // zero out the conversion part
+        configRegister |= code << 6;                 // shift in the bus conversion time
+      }  // if-then set bus conversion time
+      if (bitRead(config._settings, INA_SET_SHUNT_CONVERSION)) {
+        for (code = 7; conversionTimes[code] > config._shuntConv; code--) {}
+        configRegister &= ~INA226_CONFIG_SADC_MASK;  // zero out the conversion part
+        configRegister |= code << 3;                 // shift in the shunt conversion time
+      }  // if-then set shunt conversion time
+      break;
+  }  // of switch type
+  return configRegister;
+}  // of method configValue()
+const char *INA_Class::getDeviceName(const uint8_t deviceNumber) const {
   /*! @brief     returns character buffer with the name of the device specified in the input param
       @details   See function definition for list of possible return values
       @param[in] deviceNumber to return the device name of
       @return    device name */
-  if (deviceNumber > _DeviceCount) return ("");
-  readInafromEEPROM(deviceNumber);  // Load EEPROM to ina structure
-  switch (ina.type) {
+  inaDet        scratch;
+  const inaDet *dev = descriptor(deviceNumber, scratch);
+  if (dev == nullptr) return ("");
+  switch (dev->type) {
     case INA219: return ("INA219");
     case INA226: return ("INA226");
     case INA228: return ("INA228");
@@ -561,136 +1480,107 @@ const char *INA_Class::getDeviceName(const uint8_t deviceNumber) {
     default: return ("UNKNOWN");
   }  // of switch type
 }  // of method getDeviceName()
-uint8_t INA_Class::getDeviceAddress(const uint8_t deviceNumber) {
+uint8_t INA_Class::getDeviceAddress(const uint8_t deviceNumber) const {
   /*! @brief     returns a I2C address of the device specified in the input parameter
       @details   Return the I2C address of the specified device, if number is out of range return 0
       @param[in] deviceNumber to return the device name of
       @return    I2C address of the device. Returns 0 if value is out-of-range
       */
-  if (deviceNumber > _DeviceCount) return 0;
-  readInafromEEPROM(deviceNumber);  // Load EEPROM to ina structure
-  return (ina.address);
+  inaDet        scratch;
+  const inaDet *dev = descriptor(deviceNumber, scratch);
+  if (dev == nullptr) return 0;
+  return (dev->address);
 }  // of method getDeviceAddress()
-uint16_t INA_Class::getBusMilliVolts(const uint8_t deviceNumber) {
+uint8_t INA_Class::getDeviceBus(const uint8_t deviceNumber) const {
+  /*! @brief     returns the I2C bus of the device specified in the input parameter
+      @param[in] deviceNumber to return the bus of
+      @return    Bus number, 0 for "Wire" and otherwise as returned by addBus(). Returns 0 if value
+                 is out-of-range */
+  inaDet        scratch;
+  const inaDet *dev = descriptor(deviceNumber, scratch);
+  if (dev == nullptr) return 0;
+  return (dev->bus);
+}  // of method getDeviceBus()
+uint8_t INA_Class::getDeviceChannel(const uint8_t deviceNumber) const {
+  /*! @brief     returns the mux channel of the device specified in the input parameter
+      @param[in] deviceNumber to return the channel of
+      @return    Mux number (as returned by addMux()) * 8 + channel, or UINT8_MAX if the device is
+                 connected directly to the bus or the value is out-of-range */
+  inaDet        scratch;
+  const inaDet *dev = descriptor(deviceNumber, scratch);
+  if (dev == nullptr) return UINT8_MAX;
+  return (dev->muxChannel - 1);
+}  // of method getDeviceChannel()
+uint16_t INA_Class::getBusMilliVolts(const uint8_t deviceNumber) const {
   /*! @brief     returns the bus voltage in millivolts
       @details   The converted millivolt value is returned and if the device is in triggered mode
                  the next conversion is started
       @param[in] deviceNumber to return the device bus millivolts for
       @return uint16_t unsigned integer for the bus millivoltage */
-  uint32_t busVoltage = getBusRaw(deviceNumber);  // Get raw voltage from device
-  if (ina.type == INA228) {
-    // The accuracy is 20bits and 195.3125uv is the LSB
-    busVoltage = (uint64_t)busVoltage * 1953125 / 10000000;  // conversion to get mV
-  } else {
-    busVoltage = busVoltage * ina.busVoltage_LSB / 100;  // conversion to get mV
-  }                                                      // if-then-else an INA228
-  return (busVoltage);
+  int32_t    raw[INA_ROLE_CONFIG] = {0};  // Raw register values by role
+  inaReading reading;
+  measure(deviceNumber, INA_READ_BUS, raw, reading);
+  return (reading.busMilliVolts);
 }  // of method getBusMilliVolts()
-uint32_t INA_Class::getBusRaw(const uint8_t deviceNumber) {
+uint32_t INA_Class::getBusRaw(const uint8_t deviceNumber) const {
   /*! @brief     returns the raw unconverted bus voltage reading from the device
       @details   The raw measured value is returned and if the device is in triggered mode the next
                  conversion is started
       @param[in] deviceNumber to return the raw device bus voltage reading
       @return    Raw bus measurement */
-  readInafromEEPROM(deviceNumber);  // Load EEPROM from EEPROM
-  uint32_t raw{0};                  // define the return variable
-  if (ina.type == INA228) {
-    raw = read3Bytes(ina.busVoltageRegister, ina.address);  // Get the raw value from register
-    raw = raw >> 4;
-  } else {
-    raw = readWord(ina.busVoltageRegister, ina.address);  // Get the raw value from register
-    if (ina.type == INA3221_0 || ina.type == INA3221_1 || ina.type == INA3221_2 ||
-        ina.type == INA219) {
-      raw = raw >> 3;  // INA219 & INA3221 - the 3 LSB unused, so shift right
-    }                  // of if-then an INA219 or INA3221
-  }                    // if-then a 3byte bus voltage buffer
-  if (!bitRead(ina.operatingMode, 2) && bitRead(ina.operatingMode, 1))  // Triggered & bus active
-  {
-    int16_t configRegister =
-        readWord(INA_CONFIGURATION_REGISTER, ina.address);               // Get current value
-    writeWord(INA_CONFIGURATION_REGISTER, configRegister, ina.address);  // Write to trigger next
-  }  // of if-then triggered mode enabled
-  return (raw);
+  int32_t    raw[INA_ROLE_CONFIG] = {0};  // Raw register values by role
+  inaReading reading;
+  uint8_t    type = measure(deviceNumber, INA_READ_BUS, raw, reading);
+  if (type == INA228) return (uint32_t)raw[INA_ROLE_BUS] >> 4;  // 20 bits, left aligned
+  if (type == INA219 || type == INA3221_0 || type == INA3221_1 || type == INA3221_2) {
+    return (uint16_t)raw[INA_ROLE_BUS] >> 3;  // INA219 & INA3221 - the 3 LSB unused
+  }  // of if-then an INA219 or INA3221
+  return ((uint16_t)raw[INA_ROLE_BUS]);  // Unsigned raw value
 }  // of method getBusRaw()
-int32_t INA_Class::getShuntMicroVolts(const uint8_t deviceNumber) {
+int32_t INA_Class::getShuntMicroVolts(const uint8_t deviceNumber) const {
   /*! @brief     returns the shunt reading converted to microvolts
       @details   The computed microvolts value is returned and if the device is in triggered mode
-                 the next conversion is started
+                 the next conversion is started. The INA260 has a built-in 2mOhm shunt, so for it
+                 the value is computed from the current
       @param[in] deviceNumber to return the value for
       @return    int32_t signed integer for the shunt microvolts
       */
-  int32_t shuntVoltage = getShuntRaw(deviceNumber);
-  if (ina.type == INA260)  // INA260 has a built-in shunt
-  {
-    int32_t busMicroAmps = getBusMicroAmps(deviceNumber);  // Get the amps on the bus from device
-    shuntVoltage         = busMicroAmps / 200;             // 2mOhm resistor, convert with Ohm's law
-  } else {
-    if (ina.type == INA228) {
-      shuntVoltage = shuntVoltage * ina.shuntVoltage_LSB / 10;  // Convert to microvolts
-    } else {
-      shuntVoltage = shuntVoltage * ina.shuntVoltage_LSB / 10;  // Convert to microvolts
-    }  // if-then a INA228 with 20 bit accuracy
-  }    // of if-then-else an INA260
-  return (shuntVoltage);
+  int32_t    raw[INA_ROLE_CONFIG] = {0};  // Raw register values by role
+  inaReading reading;
+  measure(deviceNumber, INA_READ_SHUNT, raw, reading);
+  return (reading.shuntMicroVolts);
 }  // of method getShuntMicroVolts()
-int32_t INA_Class::getShuntRaw(const uint8_t deviceNumber) {
+int32_t INA_Class::getShuntRaw(const uint8_t deviceNumber) const {
   /*! @brief     Returns the raw shunt reading
       @details   The raw reading is returned and if the device is in triggered mode the next
                  conversion is started
       @param[in] deviceNumber to return the value for
       @return    Raw shunt reading */
-  int32_t raw;
-  readInafromEEPROM(deviceNumber);  // Load EEPROM to ina structure
-  if (ina.type == INA260)           // INA260 has a built-in shunt
-  {
-    int32_t busMicroAmps = getBusMicroAmps(deviceNumber);  // Get the amps on the bus
-    raw                  = busMicroAmps / 200 / 1000;      // 2mOhm resistor, apply Ohm's law
-  } else {
-    if (ina.type == INA228)  // INA228 has 24 bit accuracy
-    {
-      raw = read3Bytes(ina.shuntVoltageRegister, ina.address);  // Get the raw value from register
-      // The number is two's complement, so if negative we need to pad when shifting //
-      if (raw & 0x800000) {
-        raw = (raw >> 4) | 0xFFF00000;  // first 12 bits are "1"
-      } else {
-        raw = raw >> 4;
-      }  // if-then negative
-    } else {
-      raw = readWord(ina.shuntVoltageRegister, ina.address);  // Get the raw value from register
-    }                                                         // if-then a 24 bit register
-    if (ina.type == INA3221_0 || ina.type == INA3221_1 ||
-        ina.type == INA3221_2)  // Doesn't use 3 LSB
-    {
-      raw = raw >> 3;  // shift over 3 bits, datatype is "int" so shifts in sign bits
-    }                  // of if-then we need to shift INA3221 reading over
-  }                    // of if-then-else an INA260 with inbuilt shunt
-  if (!bitRead(ina.operatingMode, 2) && bitRead(ina.operatingMode, 0))  // Triggered & shunt active
-  {
-    int16_t configRegister = readWord(INA_CONFIGURATION_REGISTER, ina.address);  // Get current reg
-    writeWord(INA_CONFIGURATION_REGISTER, configRegister, ina.address);  // Write to trigger next
-  }  // of if-then triggered mode enabled
-  return (raw);
-}  // of method getShuntMicroVolts()
-int32_t INA_Class::getBusMicroAmps(const uint8_t deviceNumber) {
+  int32_t    raw[INA_ROLE_CONFIG] = {0};  // Raw register values by role
+  inaReading reading;
+  switch (measure(deviceNumber, INA_READ_SHUNT, raw, reading)) {
+    case INA260: return reading.busMicroAmps / 200 / 1000;  // 2mOhm resistor, apply Ohm's law
+    case INA228:  // 20 bits, left aligned, two's complement so pad with "1" when negative
+      if (raw[INA_ROLE_SHUNT] & 0x800000) return (raw[INA_ROLE_SHUNT] >> 4) | 0xFFF00000;
+      return raw[INA_ROLE_SHUNT] >> 4;
+    case INA3221_0:
+    case INA3221_1:
+    case INA3221_2: return raw[INA_ROLE_SHUNT] >> 3;  // Doesn't use 3 LSB, shifts in sign bits
+    default: return (raw[INA_ROLE_SHUNT]);
+  }  // of switch type
+}  // of method getShuntRaw()
+int32_t INA_Class::getBusMicroAmps(const uint8_t deviceNumber) const {
   /*! @brief     Returns the computed microamps measured on the bus for the specified device
       @details   The computed reading is returned and if the device is in triggered mode the next
                  conversion is started
       @param[in] deviceNumber to return the value for
       @return    int32_t signed integer for computed microamps on the bus */
-  readInafromEEPROM(deviceNumber);  // Load EEPROM to ina structure
-  int32_t microAmps = 0;
-  if (ina.type == INA3221_0 || ina.type == INA3221_1 ||
-      ina.type == INA3221_2)  // Doesn't compute Amps
-  {
-    microAmps =
-        (int64_t)getShuntMicroVolts(deviceNumber) * ((int64_t)1000000 / (int64_t)ina.microOhmR);
-  } else {
-    microAmps = (int64_t)readWord(ina.currentRegister, ina.address) * (int64_t)ina.current_LSB /
-                (int64_t)1000;
-  }  // of if-then-else an INA3221
-  return (microAmps);
+  int32_t    raw[INA_ROLE_CONFIG] = {0};  // Raw register values by role
+  inaReading reading;
+  measure(deviceNumber, INA_READ_CURRENT, raw, reading);
+  return (reading.busMicroAmps);
 }  // of method getBusMicroAmps()
-int64_t INA_Class::getBusMicroWatts(const uint8_t deviceNumber) {
+int64_t INA_Class::getBusMicroWatts(const uint8_t deviceNumber) const {
   /*!
   @brief     returns the computed microwatts measured on the bus for the specified device
   @details   The computed reading is returned and if the device is in triggered mode the next
@@ -698,21 +1588,779 @@ int64_t INA_Class::getBusMicroWatts(const uint8_t deviceNumber) {
   @param[in] deviceNumber to return the value for
   @return    int64_t signed integer for computed microwatts on the bus
   */
-  int64_t microWatts = 0;
-  readInafromEEPROM(deviceNumber);  // Load EEPROM to ina structure
-  if (ina.type == INA3221_0 || ina.type == INA3221_1 ||
-      ina.type == INA3221_2)  // Doesn't compute Amps
+  int32_t    raw[INA_ROLE_CONFIG] = {0};  // Raw register values by role
+  inaReading reading;
+  measure(deviceNumber, INA_READ_POWER, raw, reading);
+  return (reading.busMicroWatts);
+}  // of method getBusMicroWatts()
+uint8_t INA_Class::measure(const uint8_t deviceNumber, const uint8_t what, int32_t raw[],
+                           inaReading &reading) const {
+  /*! @brief     Reads and converts values of a device, the common part of the getters
+      @details   Only local storage is used for the descriptor, see descriptor(), and the bus is
+                 locked (see setBusLock()) for the register reads only. In triggered mode the next
+                 conversion is started as described in rearmNeeded().
+      @param[in] deviceNumber to read
+      @param[in] what combination of "ina_Read" values
+      @param[out] raw register values indexed by role, see registersNeeded()
+      @param[out] reading converted values, all 0 if the device number is out of range
+      @return    device type, INA_UNKNOWN if the device number is out of range */
+  inaDet        scratch;
+  const inaDet *dev = descriptor(deviceNumber, scratch);
+  if (dev == nullptr) {
+    reading = inaReading();
+    return INA_UNKNOWN;
+  }  // if-then invalid device number
+  lockBus(dev->busAddress, true);
+  readRegisters(*dev, registersNeeded(*dev, what), raw);
+  if (rearmNeeded(*dev, what)) {
+    retrigger(*dev);  // Start the next conversion
+  }  // of if-then triggered mode enabled
+  lockBus(dev->busAddress, false);
+  convertReading(*dev, raw, reading);
+  return dev->type;
+}  // of method measure()
+bool INA_Class::rearmNeeded(const inaDet &dev, const uint8_t what) {
+  /*! @brief     Returns whether reading values of a device in triggered mode starts a conversion
+      @details   The next conversion is started if the bus voltage was read and the bus is
+                 measured, or if another value was read and the shunt is measured, as the getters
+                 always have. Continuous mode needs no trigger
+      @param[in] dev descriptor of the device
+      @param[in] what combination of "ina_Read" values read
+      @return    "true" if the configuration register is to be written back */
+  uint8_t measured = (what & INA_READ_BUS ? 2 : 0) | (what & ~INA_READ_BUS ? 1 : 0);  // Mode bits
+  return !bitRead(dev.operatingMode, 2) && (dev.operatingMode & measured);  // Triggered & measured
+}  // of method rearmNeeded()
+uint64_t INA_Class::getEnergyMicroJoules(const uint8_t deviceNumber) const {
+  /*!
+  @brief     returns the energy accumulated by an INA228 in microjoules
+  @details   The INA228 integrates the power of every conversion in its 40 bit ENERGY register, so
+             unlike summing getBusMicroWatts() readings nothing is lost between reads and a single
+             read replaces any number of power samples. The register counts from begin() or the
+             last resetAccumulators() call. The register LSB is 16 * 3.2 * current LSB, which with
+             the current LSB of maxBusAmps / 2^19 set by begin() is maxBusAmps * 3125 / 32 uJ.
+  @param[in] deviceNumber to return the value for
+  @return    energy in microjoules, 0 if the device is not an INA228
+  */
+  inaDet        scratch;
+  const inaDet *dev = descriptor(deviceNumber, scratch);
+  if (dev == nullptr || dev->type != INA228) return 0;
+  lockBus(dev->busAddress, true);
+  uint64_t energy = read5Bytes(INA228_ENERGY_REGISTER, dev->busAddress) * dev->maxBusAmps;
+  lockBus(dev->busAddress, false);
+  return (energy >> 5) * 3125 + ((energy & 31) * 3125 >> 5);  // Split to avoid an overflow
+}  // of method getEnergyMicroJoules()
+int64_t INA_Class::getChargeMicroCoulombs(const uint8_t deviceNumber) const {
+  /*!
+  @brief     returns the charge accumulated by an INA228 in microcoulombs
+  @details   The INA228 integrates the current of every conversion in its signed 40 bit CHARGE
+             register, see getEnergyMicroJoules(). The register LSB is the current LSB, which is
+             maxBusAmps / 2^19 or maxBusAmps * 15625 / 8192 uC.
+  @param[in] deviceNumber to return the value for
+  @return    charge in microcoulombs, negative for a net flow in the reverse direction, 0 if the
+             device is not an INA228
+  */
+  inaDet        scratch;
+  const inaDet *dev = descriptor(deviceNumber, scratch);
+  if (dev == nullptr || dev->type != INA228) return 0;
+  lockBus(dev->busAddress, true);
+  uint64_t raw = read5Bytes(INA228_CHARGE_REGISTER, dev->busAddress);
+  lockBus(dev->busAddress, false);
+  bool     minus  = raw & 0x8000000000;                                     // Two's complement
+  uint64_t charge = (minus ? 0x10000000000 - raw : raw) * dev->maxBusAmps;  // Magnitude
+  charge          = (charge >> 13) * 15625 + ((charge & 8191) * 15625 >> 13);
+  return minus ? -(int64_t)charge : (int64_t)charge;
+}  // of method getChargeMicroCoulombs()
+void INA_Class::resetAccumulators(const uint8_t deviceNumber) {
+  /*!
+  @brief     resets the INA228 energy and charge accumulators to zero
+  @details   The RSTACC bit of the configuration register is set, the device clears it again
+  @param[in] deviceNumber to reset (Optional, when not set all INA228 devices are reset)
+  */
+  for (uint8_t i = 0; i < _DeviceCount; i++)  // Loop for each device found
   {
-    microWatts =
-        ((int64_t)getShuntMicroVolts(deviceNumber) * (int64_t)1000000 / (int64_t)ina.microOhmR) *
-        (int64_t)getBusMilliVolts(deviceNumber) / (int64_t)1000;
+    if (deviceNumber == UINT8_MAX ||
+        deviceNumber % _DeviceCount == i)  // If this device needs setting
+    {
+      readInafromEEPROM(i);  // Load EEPROM to ina structure
+      if (ina.type == INA228) clearAccumulators(ina);
+    }  // of if this device needs to be set
+  }    // for-next each device loop
+}  // of method resetAccumulators()
+void INA_Class::clearAccumulators(const inaDet &dev) const {
+  /*! @brief     Sets the RSTACC bit of an INA228, which clears itself again
+      @details   The shadowed configuration is kept without the bit, so that a later write of the
+                 configuration register doesn't reset the accumulators again
+      @param[in] dev descriptor of the device */
+  uint16_t configRegister = currentConfig(dev.busAddress);
+  writeWord(INA_CONFIGURATION_REGISTER, configRegister | (1 << INA228_RSTACC_BIT), dev.busAddress);
+  shadowConfig(dev.busAddress, configRegister, true, false);
+}  // of method clearAccumulators()
+bool INA_Class::readAll(const uint8_t deviceNumber, inaReading &reading) const {
+  /*!
+  @brief     returns bus millivolts, shunt microvolts, bus microamps and bus microwatts together
+  @details   Each register needed is read exactly once and all 4 values are derived from those
+             readings, giving the same results as the 4 individual getters. Compared with calling
+             them one after the other the descriptor is loaded once, the shunt (and for the
+             INA3221 also the bus) register is not read a second time for the power computation
+             and in triggered mode the next conversion is started only once, after all registers
+             have been read.
+  @param[in] deviceNumber to return the values for
+  @param[out] reading structure which receives the 4 converted values
+  @return    "true" on success, "false" if the device number is out of range
+  */
+  int32_t raw[INA_ROLE_CONFIG] = {0};  // Raw register values by role
+  if (measure(deviceNumber, INA_READ_ALL, raw, reading) == INA_UNKNOWN) return false;
+  integrate(deviceNumber, reading, micros(), INA_READ_ALL);
+  return true;
+}  // of method readAll()
+uint16_t INA_Class::registersNeeded(const inaDet &dev, const uint8_t what) const {
+  /*! @brief     Returns the registers which have to be read to compute the requested values
+      @details   The registers are identified by their role (see "INA_ROLE_BUS" and following) for
+                 the device. Bit "role" is set if the register is needed and bit
+                 "role + INA_ROLE_WIDE" if it is a 24 bit register. Values that depend on another
+                 register pull that register in too, e.g. the power sign comes from the shunt.
+      @param[in] dev descriptor of the device
+      @param[in] what combination of "ina_Read" values
+      @return    bitmap of register roles */
+  uint16_t roles = 0;
+  switch (dev.type) {
+    case INA3221_0:
+    case INA3221_1:
+    case INA3221_2:  // No current or power register, compute from shunt and bus
+      if (what & (INA_READ_BUS | INA_READ_POWER)) bitSet(roles, INA_ROLE_BUS);
+      if (what & (INA_READ_SHUNT | INA_READ_CURRENT | INA_READ_POWER)) {
+        bitSet(roles, INA_ROLE_SHUNT);
+      }  // if-then shunt needed
+      break;
+    case INA260:  // Built-in shunt, so the shunt voltage is computed from the current
+      if (what & INA_READ_BUS) bitSet(roles, INA_ROLE_BUS);
+      if (what & (INA_READ_SHUNT | INA_READ_CURRENT | INA_READ_POWER)) {
+        bitSet(roles, INA_ROLE_CURRENT);
+      }  // if-then current needed
+      if (what & INA_READ_POWER) bitSet(roles, INA_ROLE_POWER);
+      break;
+    default:  // INA219, INA226, INA228, INA230 and INA231
+      if (what & INA_READ_BUS) bitSet(roles, INA_ROLE_BUS);
+      if (what & (INA_READ_SHUNT | INA_READ_POWER)) bitSet(roles, INA_ROLE_SHUNT);
+      if (what & INA_READ_CURRENT) bitSet(roles, INA_ROLE_CURRENT);
+      if (what & INA_READ_POWER) bitSet(roles, INA_ROLE_POWER);
+      if (dev.type == INA228) roles |= (roles & 0xF) << INA_ROLE_WIDE;  // All are 24 bit
+  }  // of switch type
+  return roles;
+}  // of method registersNeeded()
+void INA_Class::readRegisters(const inaDet &dev, const uint16_t roles, int32_t raw[]) const {
+  /*! @brief     Reads the registers returned by registersNeeded() for a device
+      @param[in] dev descriptor of the device
+      @param[in] roles bitmap of register roles as returned by registersNeeded()
+      @param[out] raw register values indexed by role, registers not read are left unchanged */
+  if (dev.type >= INA3221_0 && dev.type <= INA3221_2) {
+    inaSlot *entry = claimSlot(dev.busAddress);  // Note the channel for disableUnreadChannels()
+    if (entry != nullptr) bitSet(entry->channelsRead, dev.type - INA3221_0);
+  }  // if-then an INA3221 channel
+  for (uint8_t role = 0; role < INA_ROLE_CONFIG; role++) {
+    if (!bitRead(roles, role)) continue;  // Register not needed for this device type
+    if (bitRead(roles, role + INA_ROLE_WIDE)) {
+      raw[role] = read3Bytes(roleRegister(dev, role), dev.busAddress);
+    } else {
+      raw[role] = readWord(roleRegister(dev, role), dev.busAddress);
+    }  // if-then-else a 24 bit register
+  }    // for-next each register role
+}  // of method readRegisters()
+uint8_t INA_Class::roleRegister(const inaDet &dev, const uint8_t role) const {
+  /*! @brief     Returns the register address for a register role of a device
+      @param[in] dev descriptor of the device
+      @param[in] role one of "INA_ROLE_BUS" to "INA_ROLE_CONFIG"
+      @return    register address */
+  switch (role) {
+    case INA_ROLE_BUS: return dev.busVoltageRegister;
+    case INA_ROLE_SHUNT: return dev.shuntVoltageRegister;
+    case INA_ROLE_CURRENT: return dev.currentRegister;
+    case INA_ROLE_POWER: return dev.type == INA228 ? INA228_POWER_REGISTER : INA_POWER_REGISTER;
+    default: return INA_CONFIGURATION_REGISTER;
+  }  // of switch role
+}  // of method roleRegister()
+void INA_Class::convertReading(const inaDet &dev, const int32_t raw[],
+                               inaReading &reading) const {
+  /*! @brief     Converts raw register values of a device into a reading
+      @details   The conversions are the same as the ones used by the individual getters. Only the
+                 values whose registers were read (see registersNeeded()) are meaningful.
+      @param[in] dev descriptor of the device
+      @param[in] raw register values indexed by role, as returned by readWord() or read3Bytes()
+      @param[out] reading structure which receives the converted values */
+  int32_t  shuntRaw   = raw[INA_ROLE_SHUNT];
+  int32_t  currentRaw = raw[INA_ROLE_CURRENT];
+  uint32_t busRaw     = (uint16_t)raw[INA_ROLE_BUS];
+  switch (dev.type) {
+    case INA3221_0:
+    case INA3221_1:
+    case INA3221_2:  // No current or power register, compute from shunt and bus
+      convertINA3221(dev, shuntRaw >> 3, busRaw >> 3, reading);
+      break;
+    case INA260:  // Built-in shunt, so no shunt voltage register
+      reading.busMilliVolts   = scale(dev, INA_ROLE_BUS, busRaw);
+      reading.busMicroAmps    = scale(dev, INA_ROLE_CURRENT, raw[INA_ROLE_CURRENT]);
+      reading.shuntMicroVolts = reading.busMicroAmps / 200;  // 2mOhm resistor, Ohm's law
+      reading.busMicroWatts   = scale(dev, INA_ROLE_POWER, raw[INA_ROLE_POWER]);
+      if (reading.busMicroAmps / 200 / 1000 < 0) reading.busMicroWatts *= -1;  // as getShuntRaw()
+      break;
+    default:  // INA219, INA226, INA228, INA230 and INA231
+      if (dev.type == INA228) {
+        busRaw = (uint32_t)raw[INA_ROLE_BUS] >> 4;
+        if (shuntRaw & 0x800000) {
+          shuntRaw = (shuntRaw >> 4) | 0xFFF00000;  // first 12 bits are "1"
+        } else {
+          shuntRaw = shuntRaw >> 4;
+        }  // if-then negative
+        if (currentRaw & 0x800000) {
+          currentRaw = (currentRaw >> 4) | 0xFFF00000;  // first 12 bits are "1"
+        } else {
+          currentRaw = currentRaw >> 4;
+        }  // if-then negative
+      } else if (dev.type == INA219) {
+        busRaw = busRaw >> 3;  // the 3 LSB unused, so shift right
+      }                        // if-then-else 24 bit registers
+      reading.busMilliVolts   = scale(dev, INA_ROLE_BUS, busRaw);
+      reading.shuntMicroVolts = scale(dev, INA_ROLE_SHUNT, shuntRaw);
+      reading.busMicroAmps    = scale(dev, INA_ROLE_CURRENT, currentRaw);
+      reading.busMicroWatts   = scale(dev, INA_ROLE_POWER, raw[INA_ROLE_POWER]);
+      if (shuntRaw < 0) reading.busMicroWatts *= -1;  // Invert if negative voltage
+  }  // of switch type
+}  // of method convertReading()
+uint8_t INA_Class::startRead(const uint8_t deviceNumber, const uint8_t what,
+                             inaCallback callback) {
+  /*!
+  @brief     Starts an asynchronous read of one or more values from a device
+  @details   The request is queued and returns immediately, the I2C traffic is done in later calls
+             to poll(). When the request has completed the callback (if any) is called from
+             within poll(), otherwise the result is fetched with ready(). Requests for different
+             devices can be in flight at the same time, so one device's settle delay does not
+             hold up the others and the application can work between calls to poll(). The request
+             table is allocated on first use and holds INA_ASYNC_REQUESTS entries.
+  @param[in] deviceNumber to read
+  @param[in] what combination of "ina_Read" values, defaults to INA_READ_ALL
+  @param[in] callback [optional] function called with the result once the request completes
+  @return    request number to pass to ready(), or UINT8_MAX if the device number is invalid or
+             all request slots are in use
+  */
+  if (deviceNumber >= _DeviceCount || (what & INA_READ_ALL) == 0) return UINT8_MAX;
+  if (_Requests == nullptr) {
+    _Requests = new inaRequest[INA_ASYNC_REQUESTS];
+    for (uint8_t i = 0; i < INA_ASYNC_REQUESTS; i++) _Requests[i].state = INA_ASYNC_FREE;
+  }  // if-then first asynchronous request
+  uint8_t request = 0;
+  while (request < INA_ASYNC_REQUESTS && _Requests[request].state != INA_ASYNC_FREE) request++;
+  if (request == INA_ASYNC_REQUESTS) return UINT8_MAX;  // All slots in use
+  inaRequest &r = _Requests[request];
+  readInafromEEPROM(deviceNumber);  // Load EEPROM to ina structure
+  r.deviceNumber = deviceNumber;
+  r.address      = ina.busAddress;
+  r.what         = what;
+  r.callback     = callback;
+  r.roles        = registersNeeded(ina, what);
+  if (rearmNeeded(ina, what)) {
+    bitSet(r.roles, INA_ROLE_CONFIG);  // Read the configuration and write it back to re-arm
+  }  // of if-then triggered mode enabled
+  for (uint8_t role = 0; role <= INA_ROLE_CONFIG; role++) {
+    r.registers[role] = roleRegister(ina, role);
+    r.raw[role]       = 0;
+  }                           // for-next each register role
+  r.state = INA_ASYNC_QUEUED;  // poll() does the rest
+  return request;
+}  // of method startRead()
+bool INA_Class::poll() {
+  /*!
+  @brief     Advances all asynchronous requests
+  @details   Each request is a small state machine, see advanceRequest(). The settle delay is
+             measured with micros() rather than waited for, so a call to poll() does at most one
+             I2C transaction per request and never blocks. Only one request per I2C address is in
+             progress at a time, since the device has a single register pointer. Requests for
+             devices behind mux channels which are already selected are served first. Only when
+             none of them is in progress any more are those behind one other channel served, so
+             a mux is switched at most once per call and once per channel while requests are
+             waiting. Call it as often as possible, e.g. once per pass of "loop()".
+  @return    "true" while at least one request has not yet completed
+  */
+  if (_Requests == nullptr) return false;  // Nothing has been started yet
+  uint8_t  served  = 0;           // Bit per request advanced in this call
+  uint16_t channel = UINT16_MAX;  // Mux channel switched to in this call
+  for (uint8_t pass = 0; pass < 2; pass++) {
+    for (uint8_t i = 0; pass == 1 && i < INA_ASYNC_REQUESTS; i++) {
+      uint8_t state = _Requests[i].state;
+      if (bitRead(served, i) && state > INA_ASYNC_QUEUED && state < INA_ASYNC_DONE) return true;
+    }  // for-next each request, stay on the selected channels while they have work in progress
+    for (uint8_t i = 0; i < INA_ASYNC_REQUESTS; i++) {
+      inaRequest &r = _Requests[i];
+      if (bitRead(served, i) || r.state == INA_ASYNC_FREE || r.state == INA_ASYNC_DONE) continue;
+      lockBus(r.address, true);  // The mux state and the device belong to the bus
+      if (!channelSelected(r.address) &&
+          (pass == 0 || (channel != UINT16_MAX && channel != (r.address >> 7)))) {
+        lockBus(r.address, false);
+        continue;  // Requests on the selected channels go first, and only one switch
+      }  // if-then not served in this pass
+      if (!channelSelected(r.address)) channel = r.address >> 7;  // Mux channel switched
+      bitSet(served, i);
+      advanceRequest(r);
+      lockBus(r.address, false);
+    }  // for-next each request
+  }    // for-next each pass
+  bool busy = false;
+  for (uint8_t i = 0; i < INA_ASYNC_REQUESTS; i++) {
+    busy |= _Requests[i].state != INA_ASYNC_FREE && _Requests[i].state != INA_ASYNC_DONE;
+  }  // for-next each request
+  return busy;
+}  // of method poll()
+void INA_Class::advanceRequest(inaRequest &r) {
+  /*! @brief     Does the next step of an asynchronous request
+      @details   The steps are: waiting for its device to become free, the register pointer write,
+                 the settle delay, the register read and, in triggered mode, writing back the
+                 configuration register to start the next conversion
+      @param[in,out] r request to advance */
+  bool          written;
+  const uint8_t address = r.address & INA_ADDRESS_MASK;  // 7 bit I2C address
+  uint8_t       slot    = addressSlot(r.address);
+  uint8_t       role    = 0;
+  while (role < INA_ROLE_CONFIG && !bitRead(r.roles, role)) role++;  // Next register to read
+  switch (r.state) {
+    case INA_ASYNC_QUEUED:
+      if (bitRead(_asyncBusy, slot)) break;  // Another request is using the device
+      bitSet(_asyncBusy, slot);
+      r.state = INA_ASYNC_POINTER;
+      // fall through
+    case INA_ASYNC_POINTER:
+      if (!pointerCached(r.registers[role], r.address)) {
+        TwoWire &bus = wire(r.address);  // Selects the mux channel if necessary
+        bus.beginTransmission(address);  // Address the I2C device
+        bus.write(r.registers[role]);    // Send register address to read
+        cachePointer(r.registers[role], r.address, bus.endTransmission() == 0);
+        r.since = micros();
+        r.state = INA_ASYNC_SETTLE;
+        break;
+      }  // if-then pointer needs to be written
+      r.state = INA_ASYNC_READ;
+      break;
+    case INA_ASYNC_SETTLE:
+      if ((uint32_t)(micros() - r.since) < settleMicros(r.address)) break;  // Not yet settled
+      if ((r.roles & 0xFF) == 0) {  // Re-arm write has settled
+        finishRequest(r);
+        break;
+      }  // if-then nothing left to read
+      r.state = INA_ASYNC_READ;
+      // fall through
+    case INA_ASYNC_READ:
+      if (!pointerCached(r.registers[role], r.address)) {  // Pointer was changed meanwhile
+        r.state = INA_ASYNC_POINTER;
+        break;
+      }  // if-then pointer no longer valid
+      if (bitRead(r.roles, role + INA_ROLE_WIDE)) {
+        TwoWire &bus = wire(r.address);
+        bus.requestFrom(address, (uint8_t)3);  // Request 3 consecutive bytes
+        r.raw[role] = ((uint32_t)bus.read() << 16) | ((uint32_t)bus.read() << 8);
+        r.raw[role] |= (uint32_t)bus.read();
+      } else {
+        TwoWire &bus = wire(r.address);
+        bus.requestFrom(address, (uint8_t)2);  // Request 2 consecutive bytes
+        r.raw[role] = (int16_t)(((uint16_t)bus.read() << 8) | bus.read());
+        if (role == INA_ROLE_CONFIG) shadowConfig(r.address, r.raw[role], true, false);
+      }  // if-then-else a 24 bit register
+      bitClear(r.roles, role);
+      if (r.roles & 0xFF) {
+        r.state = INA_ASYNC_POINTER;  // More registers to read
+      } else if (role == INA_ROLE_CONFIG) {
+        r.state = INA_ASYNC_REARM;
+      } else {
+        finishRequest(r);
+      }  // if-then-else more to do
+      break;
+    case INA_ASYNC_REARM:
+      wire(r.address).beginTransmission(address);                     // Address the I2C device
+      wire(r.address).write(INA_CONFIGURATION_REGISTER);              // Send register address
+      wire(r.address).write((uint8_t)(r.raw[INA_ROLE_CONFIG] >> 8));  // Write the MSB first
+      wire(r.address).write((uint8_t)r.raw[INA_ROLE_CONFIG]);         // and then the second byte
+      written = wire(r.address).endTransmission() == 0;
+      cachePointer(INA_CONFIGURATION_REGISTER, r.address, written);
+      shadowConfig(r.address, r.raw[INA_ROLE_CONFIG], written, written);  // Conversion started
+      r.since = micros();
+      r.state = INA_ASYNC_SETTLE;  // Release the device once the write has settled
+      break;
+    default: break;  // Free or done
+  }                  // of switch state
+}  // of method advanceRequest()
+void INA_Class::finishRequest(inaRequest &r) {
+  /*! @brief     Converts the raw values of a completed request and hands them over
+      @details   The device is released for the next request, then the callback is called if one
+                 was given and the slot freed, otherwise the result is kept for ready()
+      @param[in,out] r request which has read all of its registers */
+  bitClear(_asyncBusy, addressSlot(r.address));
+  readInafromEEPROM(r.deviceNumber);  // Load EEPROM to ina structure for the LSB values
+  convertReading(ina, r.raw, r.reading);
+  integrate(r.deviceNumber, r.reading, micros(), r.what);
+  if (r.callback == nullptr) {
+    r.state = INA_ASYNC_DONE;  // Wait for ready()
   } else {
-    microWatts =
-        (int64_t)readWord(INA_POWER_REGISTER, ina.address) * (int64_t)ina.power_LSB / (int64_t)1000;
-    if (getShuntRaw(deviceNumber) < 0) microWatts *= -1;  // Invert if negative voltage
-  }                                                       // of if-then-else an INA3221
-  return (microWatts);
-}  // of method getBusMicroWatts()
+    inaReading reading = r.reading;
+    r.state            = INA_ASYNC_FREE;  // Free first, so the callback can start a new request
+    r.callback(r.deviceNumber, r.what, reading);
+  }  // if-then-else callback
+}  // of method finishRequest()
+bool INA_Class::ready(const uint8_t request, inaReading &reading) {
+  /*!
+  @brief     Returns whether an asynchronous request has completed and if so, its result
+  @details   Once "true" has been returned the request number is free to be reused by startRead().
+             Only the values asked for in startRead() are meaningful.
+  @param[in] request number returned by startRead()
+  @param[out] reading structure which receives the converted values
+  @return    "true" if the request has completed and "reading" has been filled
+  */
+  if (_Requests == nullptr || request >= INA_ASYNC_REQUESTS) return false;
+  if (_Requests[request].state != INA_ASYNC_DONE) return false;
+  reading                   = _Requests[request].reading;
+  _Requests[request].state = INA_ASYNC_FREE;
+  return true;
+}  // of method ready()
+bool INA_Class::beginSampling(const uint8_t capacity, const uint8_t what) {
+  /*!
+  @brief     Sets up background sampling driven by the devices' conversion ready alerts
+  @details   Background sampling splits the work done when a conversion has finished into 3 parts:
+             the interrupt handler for the ALERT pin (see alertOnConversion()) only calls
+             flagConversion(), which is safe to call from an interrupt as it does no I2C traffic.
+             serviceSamples(), called from "loop()" or a task, reads the flagged devices and
+             stores the raw register values together with a timestamp in a ring buffer, from which
+             readSample() takes them. The ring buffer has a single producer (serviceSamples()) and
+             a single consumer (readSample()) and needs no locks. If it is full when a sample is
+             read, the sample is dropped and counted, see getSampleOverruns().\n
+             Only the first 32 devices can be flagged. Calling this again empties the buffer.
+  @param[in] capacity [optional] number of buffer entries, rounded down to a power of 2 (2-128).
+             One entry is always kept free, so this holds capacity-1 samples
+  @param[in] what [optional] combination of "ina_Read" values to read with each sample
+  @return    "true" if the buffer could be allocated
+  */
+  uint8_t size = 2;
+  while (size < 128 && (uint8_t)(size << 1) <= capacity) size <<= 1;  // Round to a power of 2
+  delete[] _Samples;
+  _Samples            = new inaSample[size];
+  _sampleMask         = size - 1;
+  _sampleWhat         = what;
+  _sampleHead         = 0;
+  _sampleTail         = 0;
+  _sampleOverruns     = 0;
+  _pendingConversions = 0;
+  return _Samples != nullptr;
+}  // of method beginSampling()
+void IRAM_ATTR INA_Class::flagConversion(const uint8_t deviceNumber) {
+  /*!
+  @brief     Marks a device as having a finished conversion, for use in an interrupt handler
+  @details   Only a flag is set, the device is read by the next call to serviceSamples(). If
+             several devices share one ALERT line then all of them can be flagged at once.
+  @param[in] deviceNumber [optional] device to flag, when not set all devices are flagged
+  */
+  uint32_t flags = UINT32_MAX;  // All devices
+  if (deviceNumber != UINT8_MAX) flags = deviceNumber < 32 ? (uint32_t)1 << deviceNumber : 0;
+#if defined(ESP32)
+  portENTER_CRITICAL(&pendingLock);  // The other core may be taking the flags
+  _pendingConversions |= flags;
+  portEXIT_CRITICAL(&pendingLock);
+#else
+  interruptState state = disableInterrupts();  // 32 bits aren't changed atomically on 8 bit CPUs
+  _pendingConversions |= flags;
+  restoreInterrupts(state);  // Don't enable interrupts inside an interrupt handler
+#endif
+}  // of method flagConversion()
+uint8_t INA_Class::serviceSamples() {
+  /*!
+  @brief     Reads all devices flagged by flagConversion() into the sample buffer
+  @details   The device's conversion ready flag is read first, which also resets the ALERT pin.
+             Flagged devices that have no new conversion (e.g. on a shared ALERT line) are
+             skipped, the channels of an INA3221 share one flag. In triggered mode the next
+             conversion is started after the sample has been read. This is the only method which
+             adds to the sample buffer, so it must not be called from more than one task at once.
+  @return    number of samples stored
+  */
+  if (_Samples == nullptr) return 0;  // beginSampling() hasn't been called
+#if defined(ESP32)
+  portENTER_CRITICAL(&pendingLock);  // Take the flags without losing one set meanwhile
+#else
+  interruptState state = disableInterrupts();
+#endif
+  uint32_t pending    = _pendingConversions;
+  _pendingConversions = 0;
+#if defined(ESP32)
+  portEXIT_CRITICAL(&pendingLock);
+#else
+  restoreInterrupts(state);
+#endif
+  uint16_t ready  = UINT16_MAX;  // Address of the last device whose ready flag has been seen
+  uint8_t  stored = 0;
+  for (uint8_t i = 0; i < _DeviceCount && i < 32; i++) {
+    if (!bitRead(pending, i)) continue;  // Device not flagged
+    readInafromEEPROM(i);                // Load EEPROM to ina structure
+    lockBus(ina.busAddress, true);
+    if (ina.busAddress != ready) {  // INA3221 channels are numbered consecutively
+      if (!conversionReady(ina)) {
+        lockBus(ina.busAddress, false);
+        continue;  // Nothing new from this device
+      }  // if-then no new conversion
+      ready = ina.busAddress;
+    }  // if-then ready flag not yet read
+    uint8_t head = _sampleHead;
+    uint8_t next = (head + 1) & _sampleMask;
+    if (next == __atomic_load_n(&_sampleTail, __ATOMIC_ACQUIRE)) {
+      _sampleOverruns++;  // Buffer full, the sample is lost
+    } else {
+      inaSample &sample   = _Samples[head];
+      sample.timestamp    = micros();
+      sample.deviceNumber = i;
+      readRegisters(ina, registersNeeded(ina, _sampleWhat), sample.raw);
+      if (_Integrators != nullptr) {
+        inaReading reading;
+        convertReading(ina, sample.raw, reading);
+        integrate(i, reading, sample.timestamp, _sampleWhat);
+      }  // if-then integrating
+      __atomic_store_n(&_sampleHead, next, __ATOMIC_RELEASE);  // Publish the sample
+      stored++;
+    }  // if-then-else buffer full
+    if (rearmNeeded(ina, _sampleWhat)) {
+      retrigger(ina);  // Start the next conversion
+    }  // of if-then triggered mode enabled
+    lockBus(ina.busAddress, false);
+  }  // for-next each device
+  return stored;
+}  // of method serviceSamples()
+bool INA_Class::readSample(inaSample &sample) {
+  /*!
+  @brief     Takes the oldest sample from the buffer filled by serviceSamples()
+  @details   This is the only method which removes samples from the buffer, so it must not be
+             called from more than one task at once. Use convertSample() to get the values.
+  @param[out] sample receives the sample
+  @return    "true" if a sample was returned, "false" if the buffer is empty
+  */
+  if (_Samples == nullptr) return false;  // beginSampling() hasn't been called
+  uint8_t tail = _sampleTail;
+  if (tail == __atomic_load_n(&_sampleHead, __ATOMIC_ACQUIRE)) return false;  // Empty
+  sample = _Samples[tail];
+  __atomic_store_n(&_sampleTail, (uint8_t)((tail + 1) & _sampleMask), __ATOMIC_RELEASE);
+  return true;
+}  // of method readSample()
+uint8_t INA_Class::samplesAvailable() const {
+  /*! @brief     Returns the number of samples waiting in the buffer
+      @return    number of samples */
+  return (__atomic_load_n(&_sampleHead, __ATOMIC_ACQUIRE) - _sampleTail) & _sampleMask;
+}  // of method samplesAvailable()
+uint32_t INA_Class::getSampleOverruns() const {
+  /*! @brief     Returns the number of samples lost because the buffer was full
+      @return    number of samples lost since beginSampling() */
+  return _sampleOverruns;
+}  // of method getSampleOverruns()
+void INA_Class::convertSample(const inaSample &sample, inaReading &reading) const {
+  /*!
+  @brief     Converts the raw register values of a sample
+  @details   Only the values requested in beginSampling() are meaningful
+  @param[in] sample as returned by readSample()
+  @param[out] reading structure which receives the converted values
+  */
+  inaDet        scratch;
+  const inaDet *dev = descriptor(sample.deviceNumber, scratch);
+  if (dev != nullptr) convertReading(*dev, sample.raw, reading);
+}  // of method convertSample()
+bool INA_Class::beginIntegration() {
+  /*!
+  @brief     Starts integrating the energy and charge of every device in software
+  @details   Devices other than the INA228 have no accumulator of their own. Once this has been
+             called every reading taken with readAll(), readAllChannels(), snapshotAll(), an
+             asynchronous read or a background sample is also added to the device's integrator,
+             which keeps the energy in microwatt hours, the charge in microamp hours, the lowest,
+             highest and mean power and the number of readings, see snapshotIntegral(). The area
+             between 2 readings is computed as a trapezoid using integer arithmetic only, with the
+             remainder carried over so that no resolution is lost. The time between readings comes
+             from micros() (for samples the time they were read, for snapshotAll() the time the
+             conversions were started), wraparound is handled but readings must not be more than
+             71 minutes apart. Energy is only integrated from readings which include the power and
+             charge only from those which include the current, each between the two last readings
+             of that value and their own times, see "what" in startRead() and beginSampling(). The
+             lowest, highest and mean power also only use readings which include the power.
+             Individual getters like getBusMicroWatts() are not integrated.
+             Calling this again, e.g. after begin() has found more devices, resets all integrals.
+  @return    "true" if the integrator states could be allocated
+  */
+  delete[] _Integrators;
+  _Integrators     = _DeviceCount ? new inaIntegrator[_DeviceCount] : nullptr;
+  _integratorCount = _Integrators != nullptr ? _DeviceCount : 0;
+  resetIntegral();
+  return _Integrators != nullptr;
+}  // of method beginIntegration()
+bool INA_Class::snapshotIntegral(const uint8_t deviceNumber, inaIntegral &integral) const {
+  /*!
+  @brief     Returns the values integrated for a device since beginIntegration() or resetIntegral()
+  @details   The integration continues, use resetIntegral() to start again from 0
+  @param[in] deviceNumber to return the values for
+  @param[out] integral structure which receives the values
+  @return    "true" on success, "false" if the device isn't being integrated
+  */
+  if (deviceNumber >= _integratorCount) return false;  // Invalid device or not integrating
+  const inaIntegrator &state = _Integrators[deviceNumber];
+  integral.microWattHours    = state.energyHours;
+  integral.microAmpHours     = state.chargeHours;
+  integral.minMicroWatts     = state.minMicroWatts;
+  integral.maxMicroWatts     = state.maxMicroWatts;
+  integral.meanMicroWatts    = state.powerReadings ? state.powerSum / (int64_t)state.powerReadings
+                                                   : 0;
+  integral.elapsedMicros     = state.elapsedMicros;
+  integral.readings          = state.readings;
+  return true;
+}  // of method snapshotIntegral()
+void INA_Class::resetIntegral(const uint8_t deviceNumber) {
+  /*!
+  @brief     Sets the integrated values of one or all devices back to 0
+  @details   The next reading of the device only becomes the starting point of the integration
+  @param[in] deviceNumber [optional] device to reset, when not set all devices are reset
+  */
+  for (uint8_t i = 0; i < _integratorCount; i++) {
+    if (deviceNumber == UINT8_MAX || deviceNumber % _integratorCount == i) {
+      memset(&_Integrators[i], 0, sizeof(inaIntegrator));
+    }  // of if this device needs to be reset
+  }    // for-next each device loop
+}  // of method resetIntegral()
+void INA_Class::integrate(const uint8_t deviceNumber, const inaReading &reading,
+                          const uint32_t timestamp, const uint8_t what) const {
+  /*! @brief     Adds a reading to the device's integrator, see beginIntegration()
+      @param[in] deviceNumber device the reading is from
+      @param[in] reading converted values
+      @param[in] timestamp micros() value at which the reading was taken
+      @param[in] what combination of "ina_Read" values which are valid in "reading" */
+  if (deviceNumber >= _integratorCount) return;  // Not integrating
+  inaIntegrator &state = _Integrators[deviceNumber];
+  if (state.readings) {
+    state.elapsedMicros += (uint32_t)(timestamp - state.lastMicros);  // Unsigned, wraparound is OK
+  }  // if-then not the first reading
+  state.lastMicros = timestamp;
+  state.readings++;
+  if (what & INA_READ_POWER) {
+    if (state.powerReadings) {
+      accumulate(state.energyHours, state.energyPart, state.lastMicroWatts + reading.busMicroWatts,
+                 timestamp - state.lastPowerMicros);
+    }  // if-then not the first power reading
+    if (state.powerReadings == 0 || reading.busMicroWatts < state.minMicroWatts) {
+      state.minMicroWatts = reading.busMicroWatts;
+    }  // if-then new minimum
+    if (state.powerReadings == 0 || reading.busMicroWatts > state.maxMicroWatts) {
+      state.maxMicroWatts = reading.busMicroWatts;
+    }  // if-then new maximum
+    state.powerSum += reading.busMicroWatts;
+    state.lastMicroWatts  = reading.busMicroWatts;
+    state.lastPowerMicros = timestamp;
+    state.powerReadings++;
+  }  // if-then power read
+  if (what & INA_READ_CURRENT) {
+    if (state.ampsReadings) {
+      accumulate(state.chargeHours, state.chargePart,
+                 (int64_t)state.lastMicroAmps + reading.busMicroAmps,
+                 timestamp - state.lastAmpsMicros);
+    }  // if-then not the first current reading
+    state.lastMicroAmps  = reading.busMicroAmps;
+    state.lastAmpsMicros = timestamp;
+    state.ampsReadings++;
+  }  // if-then current read
+}  // of method integrate()
+void INA_Class::accumulate(int64_t &hours, int64_t &part, const int64_t sum,
+                           const uint32_t microSeconds) {
+  /*! @brief     Adds the trapezoid "sum" * "microSeconds" / 2 to a value kept in hours
+      @details   The remainder is kept in "part" in units of 1/7.2E9 hours (microseconds * 2). The
+                 time is split into seconds and microseconds, so that none of the products can
+                 overflow for sums below 2^43 (8.8MW or 8.8MA)
+      @param[in,out] hours whole hours of the integrated value
+      @param[in,out] part remainder, always less than 7.2E9 in magnitude
+      @param[in] sum sum of the previous and current values
+      @param[in] microSeconds time between the previous and current values */
+  const int64_t perHour = 7200000000LL;  // Microseconds per hour * 2
+  int64_t       seconds = sum * (int64_t)(microSeconds / 1000000);  // Value * 2 * seconds
+  hours += seconds / 7200;
+  part += (seconds % 7200) * 1000000 + sum * (int64_t)(microSeconds % 1000000);
+  hours += part / perHour;
+  part %= perHour;
+}  // of method accumulate()
+bool INA_Class::readAllChannels(const uint8_t deviceNumber, inaReading readings[3]) const {
+  /*!
+  @brief     returns the readAll() values for all 3 channels of an INA3221 together
+  @details   The shunt and bus registers of the 3 channels are at the consecutive addresses 1 to 6.
+             The INA3221 does not auto-increment its register pointer, so each register still needs
+             its own pointer write, but all 6 are read back-to-back using repeated START conditions
+             and a single STOP. The INA3221 converts its channels one after the other and updates
+             each channel's registers as it goes, so the channels may come from different
+             conversion cycles. In triggered mode the next conversion is started only once for the
+             package. "deviceNumber" may be any of the 3 channels of the package, and each channel
+             is converted using its own shunt value.
+  @param[in] deviceNumber any device number belonging to the INA3221 package
+  @param[out] readings array of 3 structures which receive channels INA3221_0, _1 and _2
+  @return    "true" on success, "false" if the device number is invalid or not an INA3221
+  */
+  inaDet        scratch;
+  const inaDet *dev = descriptor(deviceNumber, scratch);
+  if (dev == nullptr) return false;  // Invalid device number
+  if (dev->type != INA3221_0 && dev->type != INA3221_1 && dev->type != INA3221_2) return false;
+  const uint8_t firstDevice = deviceNumber - (dev->type - INA3221_0);  // Channels are consecutive
+  if (firstDevice + 2 >= _DeviceCount) return false;                    // Incomplete package
+  uint16_t registers[6];                                                // Shunt/bus per channel
+  lockBus(dev->busAddress, true);
+  readWords(INA3221_SHUNT_VOLTAGE_REGISTER, 6, registers, dev->busAddress);
+  if (rearmNeeded(*dev, INA_READ_ALL)) {  // Both shunt and bus read
+    retrigger(*dev);  // Start the next conversion
+  }  // of if-then triggered mode enabled
+  lockBus(dev->busAddress, false);
+  uint32_t now = micros();
+  for (uint8_t i = 0; i < 3; i++) {
+    dev = descriptor(firstDevice + i, scratch);  // Each channel has its own shunt
+    convertINA3221(*dev, (int16_t)registers[i * 2] >> 3, registers[i * 2 + 1] >> 3, readings[i]);
+    integrate(firstDevice + i, readings[i], now, INA_READ_ALL);
+  }  // for-next each channel
+  return true;
+}  // of method readAllChannels()
+void INA_Class::convertINA3221(const inaDet &dev, const int32_t shuntRaw, const uint32_t busRaw,
+                               inaReading &reading) const {
+  /*! @brief     Converts the raw INA3221 readings of a channel
+      @details   The INA3221 has no current or power register, so both are computed from the shunt
+                 and bus voltages using the channel's shunt resistance. The power is computed from
+                 the product of the raw values, without the rounding of the intermediate results
+      @param[in] dev descriptor of the channel
+      @param[in] shuntRaw shunt register value with the 3 unused LSB already shifted out
+      @param[in] busRaw bus register value with the 3 unused LSB already shifted out
+      @param[out] reading structure which receives the converted values */
+  reading.busMilliVolts   = scale(dev, INA_ROLE_BUS, busRaw);
+  reading.shuntMicroVolts = scale(dev, INA_ROLE_SHUNT, shuntRaw);
+  reading.busMicroAmps    = scale(dev, INA_ROLE_CURRENT, shuntRaw);
+  reading.busMicroWatts   = scale(dev, INA_ROLE_POWER, shuntRaw * (int32_t)busRaw);  // Both LSBs
+}  // of method convertINA3221()
+int64_t INA_Class::scale(const inaDet &dev, const uint8_t role, const int32_t raw) {
+  /*! @brief     Converts a raw register value with the conversion factor of its role
+      @details   Cached descriptors use the fixed-point factors computed once by "begin()", see
+                 fixedScale(). Otherwise the raw value is divided directly, which gives the same
+                 result and costs less than computing the fixed-point factors for one conversion
+      @param[in] dev descriptor of the device
+      @param[in] role one of "INA_ROLE_BUS" to "INA_ROLE_POWER"
+      @param[in] raw register value
+      @return    raw value converted, truncated towards zero */
+  if (dev.factors != nullptr) {
+    return fixedScale(raw, dev.factors->multiplier[role], dev.factors->shift[role]);
+  }  // if-then fixed-point factors cached
+  uint64_t numerator;
+  uint32_t denominator;
+  dev.conversionFactor(role, numerator, denominator);
+  if (denominator == 0) return 0;
+  return (int64_t)raw * (int64_t)numerator / (int64_t)denominator;
+}  // of method scale()
+int64_t INA_Class::fixedScale(const int32_t raw, const uint64_t multiplier, const uint8_t shift) {
+  /*! @brief     Applies a fixed-point conversion factor computed by inaFactors::fixedPoint()
+      @details   Two 32x32 bit widening multiplies and a shift. The magnitude is scaled so that the
+                 result is truncated towards zero, just like the integer division it replaces
+      @param[in] raw register value
+      @param[in] multiplier fixed-point factor
+      @param[in] shift fixed-point shift, at least 32
+      @return    raw * multiplier / 2^shift */
+  if (multiplier == 0) return 0;  // Factor of 0, see "fixedPoint()"
+  uint32_t magnitude = raw < 0 ? (uint32_t)-raw : (uint32_t)raw;
+  uint64_t low       = (uint64_t)magnitude * (uint32_t)multiplier;
+  uint64_t high      = (uint64_t)magnitude * (uint32_t)(multiplier >> 32);
+  int64_t  result    = (int64_t)((high + (low >> 32)) >> (shift - 32));  // Product >> 32 first
+  return raw < 0 ? -result : result;
+}  // of method fixedScale()
 void INA_Class::reset(const uint8_t deviceNumber) {
   /*! @brief     performs a software reset for the specified device
       @details   If no device is specified, then all devices are reset
@@ -723,7 +2371,7 @@ void INA_Class::reset(const uint8_t deviceNumber) {
         deviceNumber % _DeviceCount == i)  // If this device needs setting
     {
       readInafromEEPROM(i);  // Load EEPROM to ina structure
-      writeWord(INA_CONFIGURATION_REGISTER, INA_RESET_DEVICE, ina.address);  // Set MSB  to reset
+      writeWord(INA_CONFIGURATION_REGISTER, INA_RESET_DEVICE, ina.busAddress);  // Set MSB  to reset
       initDevice(i);                                                         // re-initialize device
     }  // of if this device needs to be set
   }    // for-next each device loop
@@ -731,129 +2379,386 @@ void INA_Class::reset(const uint8_t deviceNumber) {
 void INA_Class::setMode(const uint8_t mode, const uint8_t deviceNumber) {
   /*!
   @brief     sets the operating mode from the list given in enum type "ina_Mode" for a device
-  @details   If no device is specified, then all devices are set to the given mode
+  @details   If no device is specified, then all devices are set to the given mode. To change
+             several settings with one register write use configure() instead
   @param[in] mode Mode (see "ina_Mode" enumerated type for list of valid values
   @param[in] deviceNumber to reset (Optional, when not set then all devices are mode changed)
   */
-  int16_t configRegister;
-  for (uint8_t i = 0; i < _DeviceCount; i++)  // Loop for each device found
-  {
-    if (deviceNumber == UINT8_MAX ||
-        deviceNumber % _DeviceCount == i)  // If this device needs setting
-    {
-      readInafromEEPROM(i);  // Load EEPROM to ina structure
-      configRegister = readWord(INA_CONFIGURATION_REGISTER, ina.address);  // Get current config
-      configRegister &= ~INA_CONFIG_MODE_MASK;                             // zero out  mode bits
-      ina.operatingMode = B00000111 & mode;                                // Mask off unused bits
-      writeInatoEEPROM(i);                                                 // Store back to EEPROM
-      configRegister |= ina.operatingMode;                                 // shift mode settings
-      writeWord(INA_CONFIGURATION_REGISTER, configRegister, ina.address);  // Save new value
-    }  // if-then this device needs to be set
-  }    // for-next each device loop
+  configure(deviceNumber).mode(mode).apply();
 }  // of method setMode()
-bool INA_Class::conversionFinished(const uint8_t deviceNumber) {
+bool INA_Class::conversionFinished(const uint8_t deviceNumber) const {
   /*!
   @brief     Returns whether or not the conversion has completed
   @details   The device's conversion ready bit is read and returned. "true" denotes finished
              conversion.
   @param[in] deviceNumber to check
   */
-  if (_DeviceCount == 0) return false;             // Return finished if invalid device. Issue #65
-  readInafromEEPROM(deviceNumber % _DeviceCount);  // Load EEPROM to ina structure
+  if (_DeviceCount == 0) return false;  // Return finished if invalid device. Issue #65
+  inaDet        scratch;
+  const inaDet *dev = descriptor(deviceNumber % _DeviceCount, scratch);
+  lockBus(dev->busAddress, true);
+  bool finished = conversionReady(*dev);
+  lockBus(dev->busAddress, false);
+  return finished;
+}  // of method "conversionFinished()"
+bool INA_Class::conversionReady(const inaDet &dev) const {
+  /*!
+  @brief     Reads and resets the conversion ready flag of a device
+  @details   When the flag is set in continuous mode, the time is noted as the start of the next
+             conversion cycle for nextReadyAt(). In triggered mode no further conversion follows
+             until the next trigger.
+  @param[in] dev descriptor of the device
+  @return    "true" if a conversion has finished since the flag was last read
+  */
   uint16_t cvBits = 0;
-  switch (ina.type) {
+  switch (dev.type) {
     case INA219:
-      cvBits = readWord(INA_BUS_VOLTAGE_REGISTER, ina.address) & 2;  // Bit 2 set denotes ready
-      readWord(INA_POWER_REGISTER, ina.address);                     // Resets the "ready" bit
+      cvBits = readWord(INA_BUS_VOLTAGE_REGISTER, dev.busAddress) & 2;  // Bit 2 set denotes ready
+      readWord(INA_POWER_REGISTER, dev.busAddress);                     // Resets the "ready" bit
       break;
     case INA226:
     case INA230:
     case INA231:
-    case INA260: cvBits = readWord(INA_MASK_ENABLE_REGISTER, ina.address) & (uint16_t)8; break;
+    case INA260: cvBits = readWord(INA_MASK_ENABLE_REGISTER, dev.busAddress) & (uint16_t)8; break;
+    case INA228: cvBits = readWord(INA228_DIAG_ALERT_REGISTER, dev.busAddress) & (uint16_t)2; break;
     case INA3221_0:
     case INA3221_1:
-    case INA3221_2: cvBits = readWord(INA3221_MASK_REGISTER, ina.address) & (uint16_t)1; break;
+    case INA3221_2: cvBits = readWord(INA3221_MASK_REGISTER, dev.busAddress) & (uint16_t)1; break;
     default: cvBits = 1;
   }  // of switch type
-  if (cvBits != 0)
+  if (cvBits != 0) {
+    inaSlot *entry = claimSlot(dev.busAddress);
+    if (entry == nullptr) {
+      return (true);  // Nothing is known about the device's cycle
+    } else if (bitRead(dev.operatingMode, 2)) {  // Continuous mode, the next cycle has begun
+      entry->cycleStart = micros();
+      bitSet(entry->state, INA_SLOT_CYCLE);
+    } else {
+      bitClear(entry->state, INA_SLOT_CYCLE);  // Nothing more until triggered again
+    }  // if-then-else continuous mode
     return (true);
-  else
+  } else
     return (false);
-}  // of method "conversionFinished()"
-void INA_Class::waitForConversion(const uint8_t deviceNumber) {
+}  // of method "conversionReady()"
+uint32_t INA_Class::conversionMicros(const inaDet &dev) const {
+  /*!
+  @brief     Returns the duration of one complete conversion cycle of a device
+  @details   The duration follows from the mode, averaging and conversion times set with setMode(),
+             setAveraging(), setBusConversion() and setShuntConversion(), as described in each
+             device's datasheet. The configuration register is only read if its value isn't
+             already known from an earlier read or write.
+  @param[in] dev descriptor of the device
+  @return    cycle time in microseconds, 0 if neither bus nor shunt are being measured
+  */
+  static const uint32_t ina219Times[16]    = {84,  148,  276,  532,  84,    148,   276,   532,
+                                              532, 1060, 2130, 4260, 8510, 17020, 34050, 68100};
+  static const uint16_t conversionTimes[8] = {140, 204, 332, 588, 1100, 2116, 4156, 8244};
+  static const uint16_t ina228Times[8]     = {50, 84, 150, 280, 540, 1052, 2074, 4120};
+  static const uint16_t averages[8]        = {1, 4, 16, 64, 128, 256, 512, 1024};
+  uint16_t              configRegister;
+  uint32_t              cycle = 0;
+  if (dev.type == INA228) {
+    configRegister = readWord(INA228_ADC_CONFIG_REGISTER, dev.busAddress);  // Timing is set here
+  } else {
+    configRegister = currentConfig(dev.busAddress);
+  }  // if-then-else an INA228
+  switch (dev.type) {
+    case INA219:  // 9 to 12 bit conversions, or 2 to 128 averaged 12 bit conversions
+      if (bitRead(configRegister, 1)) cycle += ina219Times[(configRegister >> 7) & 0xF];  // Bus
+      if (bitRead(configRegister, 0)) cycle += ina219Times[(configRegister >> 3) & 0xF];
+      break;
+    case INA228:  // Mode, conversion times and averaging from the ADC_CONFIG register
+      if (bitRead(configRegister, 12)) cycle += ina228Times[(configRegister >> 9) & 7];  // Bus
+      if (bitRead(configRegister, 13)) cycle += ina228Times[(configRegister >> 6) & 7];  // Shunt
+      if (bitRead(configRegister, 14)) cycle += ina228Times[(configRegister >> 3) & 7];  // Temp
+      cycle *= averages[configRegister & 7];
+      break;
+    default:  // INA226, INA230, INA231, INA260 and INA3221
+      if (bitRead(configRegister, 1)) cycle += conversionTimes[(configRegister >> 6) & 7];  // Bus
+      if (bitRead(configRegister, 0)) cycle += conversionTimes[(configRegister >> 3) & 7];
+      if (dev.type == INA3221_0 || dev.type == INA3221_1 || dev.type == INA3221_2) {
+        cycle *= bitRead(configRegister, 12) + bitRead(configRegister, 13) +
+                 bitRead(configRegister, 14);  // Each enabled channel is converted in turn
+      }  // if-then an INA3221
+      cycle *= averages[(configRegister >> 9) & 7];
+  }  // of switch type
+  return cycle;
+}  // of method conversionMicros()
+uint32_t INA_Class::nextReadyAt(const uint8_t deviceNumber) const {
+  /*!
+  @brief     Returns when the next conversion result of a device is expected
+  @details   The library notes when a conversion cycle starts, i.e. when the configuration register
+             is written (which also triggers a conversion in triggered mode) and when a finished
+             conversion is seen in continuous mode. Adding the cycle time computed from the
+             device's configuration gives the expected completion. A scheduler can use this to
+             read the device only once the result is there. If the start of the current cycle is
+             not known the current time is returned, meaning the device should be checked now.
+  @param[in] deviceNumber to check
+  @return    micros() value at which the result is expected, may be in the past
+  */
+  if (_DeviceCount == 0) return micros();  // No devices
+  inaDet        scratch;
+  const inaDet *dev = descriptor(deviceNumber % _DeviceCount, scratch);
+  lockBus(dev->busAddress, true);
+  uint32_t cycle   = conversionMicros(*dev);
+  const inaSlot *entry   = claimSlot(dev->busAddress);
+  bool           known   = entry != nullptr && bitRead(entry->state, INA_SLOT_CYCLE);
+  uint32_t       readyAt = known ? entry->cycleStart + cycle : micros();
+  lockBus(dev->busAddress, false);
+  return readyAt;  // Unknown cycle start means check right away
+}  // of method nextReadyAt()
+bool INA_Class::waitForConversion(const uint8_t deviceNumber, const uint32_t timeout) {
   /*!
   @brief     will not return until the conversion for the specified device is finished
   @details   if no device number is specified it will wait until all devices have finished their
              current conversion. If the conversion has completed already then the flag (and
-             interrupt pin, if activated) is also reset.
+             interrupt pin, if activated) is also reset.\n
+             Rather than reading the ready flag continuously, the expected completion time from
+             nextReadyAt() is waited for and then the flag is read once. Only if the conversion
+             has not finished by then (e.g. due to the device's clock tolerance) or the start of
+             the cycle isn't known is the flag read again, every 1/16th of the cycle time. While
+             waiting yield() is called so that other tasks can run.
   @param[in] deviceNumber to reset (Optional, when not set all devices have their mode changed)
+  @param[in] timeout [optional] maximum time to wait in microseconds, 0 waits indefinitely
+  @return    "true" if the conversions finished, "false" on timeout or if a device is shut down
   */
-  uint16_t cvBits = 0;
+  uint32_t start    = micros();
+  bool     finished = true;
   for (uint8_t i = 0; i < _DeviceCount; i++)  // Loop for each device found
   {
     if (deviceNumber == UINT8_MAX ||
         deviceNumber % _DeviceCount == i)  // If this device needs setting
     {
       readInafromEEPROM(i);  // Load EEPROM to ina structure
-      cvBits = 0;
-      while (cvBits == 0)  // Loop until the value is set
+      const inaSlot *entry  = claimSlot(ina.busAddress);
+      uint32_t       cycle  = conversionMicros(ina);
+      bool           known  = entry != nullptr && bitRead(entry->state, INA_SLOT_CYCLE);
+      uint32_t       wakeAt = known ? entry->cycleStart + cycle : micros();
+      if (cycle == 0) {
+        finished = false;  // No conversion will ever finish
+        continue;
+      }  // if-then device shut down
+      while (true)  // Loop until the value is set
       {
-        switch (ina.type) {
-          case INA219:
-            cvBits =
-                readWord(INA_BUS_VOLTAGE_REGISTER, ina.address) & 2;  // Bit 2 set denotes ready
-            readWord(INA_POWER_REGISTER, ina.address);                // Resets the "ready" bit
-            break;
-          case INA226:
-          case INA230:
-          case INA231:
-          case INA260:
-            cvBits = readWord(INA_MASK_ENABLE_REGISTER, ina.address) & (uint16_t)8;
-            break;
-          case INA3221_0:
-          case INA3221_1:
-          case INA3221_2:
-            cvBits = readWord(INA3221_MASK_REGISTER, ina.address) & (uint16_t)1;
-            break;
-          default: cvBits = 1;
-        }  // of switch type
-      }    // of while the conversion hasn't finished
-    }      // of if this device needs to be set
-  }        // for-next each device loop
+        if (timeout && (int32_t)(wakeAt - (start + timeout)) > 0) wakeAt = start + timeout;
+        sleepUntil(wakeAt);
+        if (conversionReady(ina)) break;
+        if (timeout && micros() - start >= timeout) return false;  // Timed out
+        wakeAt = micros() + cycle / 16;
+      }  // of while the conversion hasn't finished
+    }    // of if this device needs to be set
+  }      // for-next each device loop
+  return finished;
 }  // of method waitForConversion()
+uint8_t INA_Class::triggerAll() {
+  /*!
+  @brief     Starts a conversion on all devices at as nearly the same time as possible
+  @details   The configuration register of each device package is written once, with all writes
+             sent back-to-back and no settle delay or EEPROM access in between. Devices behind a
+             mux are written channel by channel, each channel's writes following the switch to
+             it. The values come from the shadowed configuration registers, any which aren't
+             known yet are read before the first write. In triggered mode this starts a single
+             conversion, in continuous mode it restarts the conversion cycle, so continuous
+             devices are aligned as well. Devices measuring neither bus nor shunt are left alone.
+  @return    number of device packages (I2C addresses) triggered
+  */
+  inaSlotMask addresses = 0;  // Bit per I2C address slot to be written
+  uint8_t     channel   = 0;  // Mux channel of the slots in "addresses", 0 for none
+  uint8_t     triggered = 0, longestSettle = 0;
+  lockAllBuses(true);
+  for (uint8_t i = 0; i < _DeviceCount; i++) {
+    readInafromEEPROM(i);                        // Load EEPROM to ina structure
+    if ((ina.operatingMode & 3) == 0) continue;  // Shut down
+    if (ina.muxChannel != channel) {  // Devices are numbered channel by channel, see begin()
+      triggered += triggerSlots(addresses, channel, longestSettle);
+      addresses = 0;
+      channel   = ina.muxChannel;
+    }  // if-then next mux channel
+    const uint8_t slot = addressSlot(ina.busAddress);
+    if (bitRead(addresses, slot)) continue;  // Other channel of an INA3221 already done
+    bitSet(addresses, slot);
+    currentConfig(ina.busAddress);  // Fill the shadow if necessary
+  }  // for-next each device
+  triggered += triggerSlots(addresses, channel, longestSettle);
+  if (longestSettle) delayMicroseconds(longestSettle);  // One settle delay for all writes
+  lockAllBuses(false);
+  return triggered;
+}  // of method triggerAll()
+uint8_t INA_Class::triggerSlots(const inaSlotMask addresses, const uint8_t channel,
+                                uint8_t &longestSettle) {
+  /*! @brief     Writes the shadowed configuration register of several devices back-to-back
+      @param[in] addresses bit per I2C address slot to be written
+      @param[in] channel mux channel of the devices, see "inaEEPROM::muxChannel"
+      @param[in,out] longestSettle longest settle delay of the devices written
+      @return    number of devices written */
+  uint8_t triggered = 0;
+  for (uint8_t slot = 0; slot < INA_ADDRESS_SLOTS; slot++) {
+    if (!bitRead(addresses, slot)) continue;
+    uint16_t       address = (uint16_t)channel << 8 | slotAddress(slot);
+    const inaSlot *entry   = claimSlot(address);
+    if (entry == nullptr) continue;                     // Nothing answered there in begin()
+    const uint16_t config = entry->config;              // Filled by triggerAll()
+    TwoWire       &bus    = wire(address);              // Selects the mux channel if necessary
+    bus.beginTransmission(address & INA_ADDRESS_MASK);  // Address the I2C device
+    bus.write(INA_CONFIGURATION_REGISTER);              // Send register address
+    bus.write((uint8_t)(config >> 8));                  // Write the first (MSB) byte
+    bus.write((uint8_t)config);                         // and then the second byte
+    bool written = bus.endTransmission() == 0;
+    cachePointer(INA_CONFIGURATION_REGISTER, address, written);
+    shadowConfig(address, config, written, written);  // Conversion started
+    if (written) triggered++;
+    if (settleMicros(address) > longestSettle) longestSettle = settleMicros(address);
+  }  // for-next each I2C address
+  return triggered;
+}  // of method triggerSlots()
+uint8_t INA_Class::snapshotAll(inaReading readings[], const uint8_t count, uint32_t &timestamp) {
+  /*!
+  @brief     Returns a time-aligned reading of all devices
+  @details   All devices are started with triggerAll(), then the slowest device's expected
+             conversion time is waited for once, with 1/8th added for the tolerance of the devices'
+             internal clocks. After that the registers of every device are read, as in readAll()
+             but without starting another conversion, so all readings come from conversions
+             started within a few I2C transactions of each other. The ready flags are neither read
+             nor reset. Useful e.g. to compare the input and output power of a converter.
+  @param[out] readings array which receives the values of devices 0 to "count" - 1
+  @param[in] count number of entries in "readings"
+  @param[out] timestamp micros() value at which the conversions were started
+  @return    number of devices read, the lesser of "count" and the number of devices found
+  */
+  timestamp = micros();
+  triggerAll();
+  uint32_t triggered = micros(), wakeAt = triggered, longest = 0;
+  for (uint8_t i = 0; i < _DeviceCount; i++) {
+    readInafromEEPROM(i);  // Load EEPROM to ina structure
+    lockBus(ina.busAddress, true);
+    uint32_t cycle = conversionMicros(ina);
+    const inaSlot *entry = claimSlot(ina.busAddress);
+    bool     known = entry != nullptr && bitRead(entry->state, INA_SLOT_CYCLE);
+    uint32_t start = known ? entry->cycleStart : triggered;  // Shared slot
+    lockBus(ina.busAddress, false);
+    if (cycle == 0) continue;  // Not converting
+    if ((int32_t)(start + cycle - wakeAt) > 0) wakeAt = start + cycle;
+    if (cycle > longest) longest = cycle;
+  }  // for-next each device
+  sleepUntil(wakeAt + longest / 8);
+  uint8_t devices = count < _DeviceCount ? count : _DeviceCount;
+  for (uint8_t i = 0; i < devices; i++) {
+    readInafromEEPROM(i);                // Load EEPROM to ina structure
+    int32_t raw[INA_ROLE_CONFIG] = {0};  // Raw register values by role
+    lockBus(ina.busAddress, true);
+    readRegisters(ina, registersNeeded(ina, INA_READ_ALL), raw);
+    lockBus(ina.busAddress, false);
+    convertReading(ina, raw, readings[i]);
+    integrate(i, readings[i], timestamp, INA_READ_ALL);
+  }  // for-next each device
+  return devices;
+}  // of method snapshotAll()
+#if defined(ESP32)
+bool INA_Class::startSamplingTask(const uint16_t periodMillis, const BaseType_t core,
+                                  const UBaseType_t priority) {
+  /*!
+  @brief     Starts a FreeRTOS task which reads all devices at a fixed rate (ESP32 only)
+  @details   The task is pinned to one core and reads every device with readAll() once per
+             period, so the application core does no I2C traffic at all and the sampling rate is
+             kept steady by the scheduler even under a heavy WiFi load. Each set of readings is a
+             frame, written into one of 2 buffers while the other holds the last complete frame,
+             which latestFrame() copies without locking or calling into the I2C code.\n
+             While the task runs it owns the buses and the library: no other method except
+             latestFrame() may be called until stopSamplingTask() has returned. Settings have to be
+             made and integration (see beginIntegration()) started before this is called.
+  @param[in] periodMillis time from the start of one frame to the start of the next, if reading
+             all devices takes longer the next frame is started right away
+  @param[in] core [optional] core to pin the task to, by default 0 (Arduino's "loop()" runs on 1)
+  @param[in] priority [optional] FreeRTOS priority of the task
+  @return    "true" if the task was started, "false" if it is already running, no devices have
+             been found or the task couldn't be created
+  */
+  if (_samplingTask != nullptr || _DeviceCount == 0) return false;
+  delete[] _Frames;
+  _Frames = new inaReading[2 * _DeviceCount];
+  if (_Frames == nullptr) return false;
+  _frameDevices  = _DeviceCount;
+  _frameSequence = 0;
+  _framePeriod   = pdMS_TO_TICKS(periodMillis) ? pdMS_TO_TICKS(periodMillis) : 1;
+  _samplingStop  = false;
+  return xTaskCreatePinnedToCore(samplingTask, "INA", INA_SAMPLING_STACK, this, priority,
+                                 &_samplingTask, core) == pdPASS;
+}  // of method startSamplingTask()
+void INA_Class::stopSamplingTask() {
+  /*!
+  @brief     Ends the task started by startSamplingTask()
+  @details   The task finishes the frame it is reading, so this returns at most one period later.
+             The last frame remains available from latestFrame()
+  */
+  if (__atomic_load_n(&_samplingTask, __ATOMIC_ACQUIRE) == nullptr) return;  // Not running
+  __atomic_store_n(&_samplingStop, true, __ATOMIC_RELAXED);
+  while (__atomic_load_n(&_samplingTask, __ATOMIC_ACQUIRE) != nullptr) vTaskDelay(1);
+}  // of method stopSamplingTask()
+void INA_Class::samplingTask(void *parameter) {
+  /*!
+  @brief     Body of the task started by startSamplingTask()
+  @details   Frames alternate between the 2 buffers. "_frameSequence" counts the frames published,
+             the last complete one is in buffer "_frameSequence & 1" and the next one is written
+             into the other buffer, see latestFrame()
+  @param[in] parameter the INA_Class instance
+  */
+  INA_Class &self = *(INA_Class *)parameter;
+  TickType_t wake = xTaskGetTickCount();
+  while (!__atomic_load_n(&self._samplingStop, __ATOMIC_RELAXED)) {
+    const uint32_t sequence = self._frameSequence;  // Only this task changes the value
+    const uint8_t  back     = (sequence + 1) & 1;   // Buffer not holding the published frame
+    inaReading    *frame    = self._Frames + back * self._frameDevices;
+    self._frameTime[back]   = micros();
+    for (uint8_t i = 0; i < self._frameDevices; i++) self.readAll(i, frame[i]);
+    __atomic_store_n(&self._frameSequence, sequence + 1, __ATOMIC_RELEASE);  // Publish
+    __atomic_thread_fence(__ATOMIC_RELEASE);  // before the next frame overwrites the older one
+    vTaskDelayUntil(&wake, self._framePeriod);
+  }  // of while not stopped
+  __atomic_store_n(&self._samplingTask, (TaskHandle_t) nullptr, __ATOMIC_RELEASE);
+  vTaskDelete(nullptr);
+}  // of method samplingTask()
+uint32_t INA_Class::latestFrame(inaReading readings[], const uint8_t count,
+                                uint32_t &timestamp) const {
+  /*!
+  @brief     Returns the last complete frame read by the sampling task
+  @details   Safe to call from any task on either core while the sampling task runs, as it only
+             copies from the frame buffers and never blocks. The copy is a seqlock read: if the
+             task has published another frame meanwhile, and so may have started overwriting the
+             buffer being copied, the copy is simply repeated. With 2 buffers that only happens if
+             the copy takes longer than the period.
+  @param[out] readings array which receives the values of devices 0 to "count" - 1
+  @param[in] count number of entries in "readings"
+  @param[out] timestamp micros() value at which the task started reading the frame
+  @return    frame number, counting from 1, or 0 if no frame has been completed yet. Consecutive
+             calls returning the same number got the same frame
+  */
+  if (_Frames == nullptr) return 0;  // startSamplingTask() hasn't been called
+  const uint8_t devices = count < _frameDevices ? count : _frameDevices;
+  uint32_t      sequence;
+  do {
+    sequence = __atomic_load_n(&_frameSequence, __ATOMIC_ACQUIRE);
+    if (sequence == 0) return 0;  // Nothing published yet
+    const inaReading *frame = _Frames + (sequence & 1) * _frameDevices;
+    for (uint8_t i = 0; i < devices; i++) readings[i] = frame[i];
+    timestamp = _frameTime[sequence & 1];
+    __atomic_thread_fence(__ATOMIC_ACQUIRE);  // Finish the copy before checking again
+  } while (__atomic_load_n(&_frameSequence, __ATOMIC_RELAXED) != sequence);
+  return sequence;
+}  // of method latestFrame()
+#endif
 bool INA_Class::alertOnConversion(const bool alertState, const uint8_t deviceNumber) {
   /*!
   @brief     configures the INA devices which support this functionality to pull the ALERT pin low
              when a conversion is complete
   @details   This call is ignored and returns false when called for an invalid device as the INA219
-             doesn't have this pin it won't work for that device.
+             doesn't have this pin it won't work for that device. Any limit function set before is
+             switched off, use setAlert() to combine both
   @param[in] alertState Boolean true or false to denote the requested setting
   @param[in] deviceNumber to reset (Optional, when not set all devices have their mode changed)
   @return    Returns "true" on success, otherwise false
   */
-  uint16_t alertRegister;
-  bool     returnCode = false;                // Assume the worst
-  for (uint8_t i = 0; i < _DeviceCount; i++)  // Loop for each device found
-  {
-    if (deviceNumber == UINT8_MAX || deviceNumber == i)  // If this device needs setting
-    {
-      readInafromEEPROM(i);  // Load EEPROM to ina structure
-      switch (ina.type) {
-        case INA226:
-        case INA230:
-        case INA231:
-        case INA260:
-          alertRegister = readWord(INA_MASK_ENABLE_REGISTER, ina.address);      // Get register
-          alertRegister &= INA_ALERT_MASK;                                      // Mask off all bits
-          if (alertState) bitSet(alertRegister, INA_ALERT_CONVERSION_RDY_BIT);  // Turn on the bit
-          writeWord(INA_MASK_ENABLE_REGISTER, alertRegister, ina.address);      // Write back
-          returnCode = true;
-          break;
-        default: returnCode = false;
-      }  // of switch type
-    }    // of if this device needs to be set
-  }      // for-next each device loop
-  return (returnCode);
+  inaAlert alert = {INA_LIMIT_NONE, 0, alertState, false, false};
+  return writeAlert(alert, deviceNumber, true);
 }  // of method AlertOnConversion
 bool INA_Class::alertOnShuntOverVoltage(const bool alertState, const int32_t milliVolts,
                                         const uint8_t deviceNumber) {
@@ -866,33 +2771,9 @@ bool INA_Class::alertOnShuntOverVoltage(const bool alertState, const int32_t mil
   @param[in] deviceNumber to reset (Optional, when not set all devices have their mode changed)
   @return    Returns "true" on success, otherwise false
   */
-  uint16_t alertRegister;
-  bool     returnCode = false;                // Assume the worst
-  for (uint8_t i = 0; i < _DeviceCount; i++)  // Loop for each device found
-  {
-    if (deviceNumber == UINT8_MAX || deviceNumber == i)  // If this device needs to be processed
-    {
-      readInafromEEPROM(i);  // Load EEPROM to ina structure
-      switch (ina.type) {
-        case INA226:
-        case INA230:
-        case INA231:
-          alertRegister = readWord(INA_MASK_ENABLE_REGISTER, ina.address);  // Get current register
-          alertRegister &= INA_ALERT_MASK;                                  // Mask off all bits
-          if (alertState)  // If true, then also set threshold
-          {
-            bitSet(alertRegister, INA_ALERT_SHUNT_OVER_VOLT_BIT);           // Turn on the bit
-            uint16_t threshold = milliVolts * 1000 / ina.shuntVoltage_LSB;  // Compute using LSB
-            writeWord(INA_ALERT_LIMIT_REGISTER, threshold, ina.address);    // Write register
-          }  // of if we are setting a value
-          writeWord(INA_MASK_ENABLE_REGISTER, alertRegister, ina.address);  // Write register back
-          returnCode = true;
-          break;
-        default: returnCode = false;
-      }  // of switch type
-    }    // of if this device needs to be set
-  }      // for-next each device loop
-  return (returnCode);
+  inaAlert alert = {alertState ? INA_LIMIT_SHUNT_OVER : INA_LIMIT_NONE, milliVolts * 1000, false,
+                    false, false};
+  return writeAlert(alert, deviceNumber, true);
 }  // of method AlertOnShuntOverVoltage
 bool INA_Class::alertOnShuntUnderVoltage(const bool alertState, const int32_t milliVolts,
                                          const uint8_t deviceNumber) {
@@ -904,33 +2785,9 @@ bool INA_Class::alertOnShuntUnderVoltage(const bool alertState, const int32_t mi
   @param[in] milliVolts alert level at which to trigger the alarm
   @param[in] deviceNumber to reset (Optional, when not set all devices have their alert changed)
   @return    Returns "true" on success, otherwise false */
-  uint16_t alertRegister;
-  bool     returnCode = true;
-  for (uint8_t i = 0; i < _DeviceCount; i++)  // Loop for each device found
-  {
-    if (deviceNumber == UINT8_MAX ||
-        deviceNumber % _DeviceCount == i)  // If this device needs setting
-    {
-      readInafromEEPROM(i);  // Load EEPROM to ina structure
-      switch (ina.type) {
-        case INA226:
-        case INA230:
-        case INA231:
-          alertRegister = readWord(INA_MASK_ENABLE_REGISTER, ina.address);  // Get current register
-          alertRegister &= INA_ALERT_MASK;                                  // Mask off all bits
-          if (alertState)                                                   // Also set threshold
-          {
-            bitSet(alertRegister, INA_ALERT_SHUNT_UNDER_VOLT_BIT);          // Turn on the bit
-            uint16_t threshold = milliVolts * 1000 / ina.shuntVoltage_LSB;  // Compute using LSB
-            writeWord(INA_ALERT_LIMIT_REGISTER, threshold, ina.address);    // Write register
-          }  // of if we are setting a value
-          writeWord(INA_MASK_ENABLE_REGISTER, alertRegister, ina.address);  // Write register back
-          break;
-        default: returnCode = false;
-      }  // of switch type
-    }    // of if this device needs to be set
-  }      // for-next each device loop
-  return (returnCode);
+  inaAlert alert = {alertState ? INA_LIMIT_SHUNT_UNDER : INA_LIMIT_NONE, milliVolts * 1000, false,
+                    false, false};
+  return writeAlert(alert, deviceNumber, true);
 }  // of method AlertOnShuntUnderVoltage
 bool INA_Class::alertOnBusOverVoltage(const bool alertState, const int32_t milliVolts,
                                       const uint8_t deviceNumber) {
@@ -943,35 +2800,9 @@ bool INA_Class::alertOnBusOverVoltage(const bool alertState, const int32_t milli
   @param[in] deviceNumber to reset (Optional, when not set all devices have their alert changed)
   @return    Returns "true" on success, otherwise false
   */
-  uint16_t alertRegister;
-  bool     returnCode = true;
-  for (uint8_t i = 0; i < _DeviceCount; i++)  // Loop for each device found
-  {
-    if (deviceNumber == UINT8_MAX ||
-        deviceNumber % _DeviceCount == i)  // If this device needs setting
-    {
-      readInafromEEPROM(i);  // Load EEPROM to ina structure
-      switch (ina.type) {
-        case INA226:  // Devices that have an alert pin
-        case INA230:
-        case INA231:
-        case INA260:
-          alertRegister =
-              readWord(INA_MASK_ENABLE_REGISTER, ina.address);  // Get the current register
-          alertRegister &= INA_ALERT_MASK;                      // Mask off all bits
-          if (alertState)                                       // Also set threshold
-          {
-            bitSet(alertRegister, INA_ALERT_BUS_OVER_VOLT_BIT);           // Turn on the bit
-            uint16_t threshold = milliVolts * 100 / ina.busVoltage_LSB;   // Compute using LSB val
-            writeWord(INA_ALERT_LIMIT_REGISTER, threshold, ina.address);  // Write register
-          }  // of if we are setting a value
-          writeWord(INA_MASK_ENABLE_REGISTER, alertRegister, ina.address);  // Write register back
-          break;
-        default: returnCode = false;
-      }  // of switch type
-    }    // of if this device needs to be set
-  }      // for-next each device loop
-  return (returnCode);
+  inaAlert alert = {alertState ? INA_LIMIT_BUS_OVER : INA_LIMIT_NONE, milliVolts, false, false,
+                    false};
+  return writeAlert(alert, deviceNumber, true);
 }  // of method AlertOnBusOverVoltageConversion
 bool INA_Class::alertOnBusUnderVoltage(const bool alertState, const int32_t milliVolts,
                                        const uint8_t deviceNumber) {
@@ -984,141 +2815,461 @@ bool INA_Class::alertOnBusUnderVoltage(const bool alertState, const int32_t mill
   @param[in] deviceNumber to reset (Optional, when not set then all devices have their alert
   changed)
   @return    Returns "true" on success, otherwise false */
-  uint16_t alertRegister;
-  bool     returnCode = true;                 // Assume success
-  for (uint8_t i = 0; i < _DeviceCount; i++)  // Loop for each device found
-  {
-    if (deviceNumber == UINT8_MAX ||
-        deviceNumber % _DeviceCount == i)  // If this device needs setting
-    {
-      readInafromEEPROM(i);  // Load EEPROM to ina structure
-      switch (ina.type) {
-        case INA226:  // Devices that have an alert pin
-        case INA230:
-        case INA231:
-        case INA260:
-          alertRegister = readWord(INA_MASK_ENABLE_REGISTER, ina.address);  // Get current register
-          alertRegister &= INA_ALERT_MASK;                                  // Mask off all bits
-          if (alertState)                                                   // Also set threshold
-          {
-            bitSet(alertRegister, INA_ALERT_BUS_UNDER_VOLT_BIT);          // Turn on the bit
-            uint16_t threshold = milliVolts * 100 / ina.busVoltage_LSB;   // Compute using LSB val
-            writeWord(INA_ALERT_LIMIT_REGISTER, threshold, ina.address);  // Write register
-          }  // of if we are setting a value
-          writeWord(INA_MASK_ENABLE_REGISTER, alertRegister, ina.address);  // Write register back
-          break;
-        default: returnCode = false;
-      }  // of switch type
-    }    // of if this device needs to be set
-  }      // for-next each device loop
-  return (returnCode);
+  inaAlert alert = {alertState ? INA_LIMIT_BUS_UNDER : INA_LIMIT_NONE, milliVolts, false, false,
+                    false};
+  return writeAlert(alert, deviceNumber, true);
 }  // of method AlertOnBusUnderVoltage
 bool INA_Class::alertOnPowerOverLimit(const bool alertState, const int32_t milliAmps,
                                       const uint8_t deviceNumber) {
   /*!
   @brief     configures the INA devices which support this functionality to pull the ALERT pin
              low when the power exceeds the value set in the parameter in milliamps
-  @details   This call is ignored and returns false when called for an invalid device
+  @details   This call is ignored and returns false when called for an invalid device. The limit
+             is compared with the power register, so "milliAmps" is a value in milliwatts
   @param[in] alertState Boolean true or false to denote the requested setting
   @param[in] milliAmps alert level at which to trigger the alarm
   @param[in] deviceNumber to reset (Optional, when not set all devices have their alert changed)
   @return    Returns "true" on success, otherwise false
   */
-  uint16_t alertRegister;
-  bool     returnCode = true;                 // assume success
-  for (uint8_t i = 0; i < _DeviceCount; i++)  // Loop for each device found
-  {
-    if (deviceNumber == UINT8_MAX ||
-        deviceNumber % _DeviceCount == i)  // If this device needs setting
-    {
-      readInafromEEPROM(i);  // Load EEPROM to ina structure
-      switch (ina.type) {
-        case INA226:
-        case INA230:
-        case INA231:
-        case INA260:  // Devices with alert pin
-          alertRegister = readWord(INA_MASK_ENABLE_REGISTER, ina.address);  // Get current register
-          alertRegister &= INA_ALERT_MASK;                                  // Mask off all bits
-          if (alertState)                                                   // Also set threshold
-          {
-            bitSet(alertRegister, INA_ALERT_POWER_OVER_WATT_BIT);         // Turn on the bit
-            uint16_t threshold = milliAmps * 1000000 / ina.power_LSB;     // Compute using LSB val
-            writeWord(INA_ALERT_LIMIT_REGISTER, threshold, ina.address);  // Write register
-          }  // of if we are setting a value
-          writeWord(INA_MASK_ENABLE_REGISTER, alertRegister, ina.address);  // Write register back
-          break;
-        default: returnCode = false;
-      }  // of switch type
-    }    // of if this device needs to be set
-  }      // for-next each device loop
-  return (returnCode);
+  inaAlert alert = {alertState ? INA_LIMIT_POWER_OVER : INA_LIMIT_NONE, milliAmps, false, false,
+                    false};
+  return writeAlert(alert, deviceNumber, true);
 }  // of method AlertOnPowerOverLimit
+bool INA_Class::setAlert(const inaAlert &alert, const uint8_t deviceNumber) {
+  /*!
+  @brief     Sets everything the ALERT pin of one or all devices signals in one go
+  @details   The alertOn...() methods each switch off whatever the pin signalled before. Here the
+             conversion ready signal, one limit function and the latch and polarity of the pin are
+             given together and compiled into the mask/enable and alert limit register values of
+             each device, which are then written in a single pass over the devices. Registers
+             which already hold the value are not written again, so the same settings can be
+             applied repeatedly at no cost. The limit is written before the mask/enable register.
+             The limit is given in microvolts for the shunt functions, millivolts for the bus
+             functions and milliwatts for the power function, and is clamped to the range of the
+             limit register. With "latch" set the pin stays asserted until conversionFinished()
+             or another read of the mask/enable register, otherwise it follows the condition
+  @param[in] alert settings, see "inaAlert"
+  @param[in] deviceNumber to set (Optional, when not set all devices are set)
+  @return    "true" if all the devices set support the settings. The INA219 has no ALERT pin,
+             the INA260 measures no shunt voltage and the INA228 and INA3221 have other alert
+             registers, these devices are left unchanged
+  */
+  return writeAlert(alert, deviceNumber, false);
+}  // of method setAlert()
+bool INA_Class::writeAlert(const inaAlert &alert, const uint8_t deviceNumber,
+                           const bool keepPin) {
+  /*! @brief     Writes the alert registers of one or all devices, see setAlert()
+      @param[in] alert settings
+      @param[in] deviceNumber device to set, UINT8_MAX for all
+      @param[in] keepPin true to keep the latch and polarity bits the device has
+      @return    "true" if all devices set support the settings */
+  bool     returnCode = true;
+  uint16_t mask, limit;
+  for (uint8_t i = 0; i < _DeviceCount; i++) {  // Loop for each device found
+    if (deviceNumber != UINT8_MAX && deviceNumber % _DeviceCount != i) continue;
+    inaDet        scratch;
+    const inaDet *dev = descriptor(i, scratch);
+    if (!alertRegisters(*dev, alert, mask, limit)) {
+      returnCode = false;
+      continue;
+    }  // if-then not supported by this device
+    if (keepPin) {
+      mask |= readShadowed(INA_SHADOW_MASK, INA_MASK_ENABLE_REGISTER, dev->busAddress) &
+              (1 << INA_ALERT_POLARITY_BIT | 1 << INA_ALERT_LATCH_BIT);
+    }  // if-then keep latch and polarity
+    if (alert.limitFunction != INA_LIMIT_NONE) {
+      writeShadowed(INA_SHADOW_LIMIT, INA_ALERT_LIMIT_REGISTER, limit, dev->busAddress);
+    }  // if-then limit function used
+    writeShadowed(INA_SHADOW_MASK, INA_MASK_ENABLE_REGISTER, mask, dev->busAddress);
+  }  // for-next each device
+  return returnCode;
+}  // of method writeAlert()
+bool INA_Class::alertRegisters(const inaDet &dev, const inaAlert &alert, uint16_t &mask,
+                               uint16_t &limit) const {
+  /*! @brief     Computes the mask/enable and alert limit register values of a device
+      @param[in] dev descriptor of the device
+      @param[in] alert settings, see setAlert()
+      @param[out] mask mask/enable register value
+      @param[out] limit alert limit register value, only set if a limit function is used
+      @return    "false" if the device doesn't support the settings */
+  static const uint8_t functionBits[] = {
+      0, INA_ALERT_SHUNT_OVER_VOLT_BIT, INA_ALERT_SHUNT_UNDER_VOLT_BIT, INA_ALERT_BUS_OVER_VOLT_BIT,
+      INA_ALERT_BUS_UNDER_VOLT_BIT, INA_ALERT_POWER_OVER_WATT_BIT};  // Bit per "ina_Limit"
+  int64_t value = 0;  // Limit in register LSBs
+  switch (dev.type) {
+    case INA226:
+    case INA230:
+    case INA231: break;
+    case INA260:  // The shunt is internal, its limit functions are current limits
+      if (alert.limitFunction == INA_LIMIT_SHUNT_OVER ||
+          alert.limitFunction == INA_LIMIT_SHUNT_UNDER) {
+        return false;
+      }  // if-then shunt limit
+      break;
+    default: return false;  // No ALERT pin or other registers
+  }  // of switch type
+  if (alert.limitFunction > INA_LIMIT_POWER_OVER) return false;
+  mask = 0;
+  if (alert.limitFunction != INA_LIMIT_NONE) bitSet(mask, functionBits[alert.limitFunction]);
+  if (alert.conversionReady) bitSet(mask, INA_ALERT_CONVERSION_RDY_BIT);
+  if (alert.activeHigh) bitSet(mask, INA_ALERT_POLARITY_BIT);
+  if (alert.latch) bitSet(mask, INA_ALERT_LATCH_BIT);
+  switch (alert.limitFunction) {
+    case INA_LIMIT_SHUNT_OVER:
+    case INA_LIMIT_SHUNT_UNDER:  // Signed, LSB in tenths of a microvolt
+      value = (int64_t)alert.limit * 10 / dev.shuntVoltage_LSB;
+      value = value > INT16_MAX ? INT16_MAX : value < INT16_MIN ? INT16_MIN : value;
+      break;
+    case INA_LIMIT_BUS_OVER:
+    case INA_LIMIT_BUS_UNDER:  // LSB in hundredths of a millivolt
+      value = (int64_t)alert.limit * 100 / dev.busVoltage_LSB;
+      value = value > 0x7FFF ? 0x7FFF : value < 0 ? 0 : value;
+      break;
+    case INA_LIMIT_POWER_OVER:  // LSB in nanowatts
+      value = (int64_t)alert.limit * 1000000 / dev.power_LSB;
+      value = value > UINT16_MAX ? UINT16_MAX : value < 0 ? 0 : value;
+      break;
+  }  // of switch limit function
+  limit = (uint16_t)value;
+  return true;
+}  // of method alertRegisters()
+uint16_t INA_Class::getAlertFlags(const uint8_t deviceNumber) const {
+  /*!
+  @brief     Returns the alert and conversion ready flags of a device
+  @details   The register holding the flags is read, the mask/enable register on the INA226,
+             INA230, INA231, INA260 and INA3221 and the DIAG_ALRT register on the INA228. Reading
+             it resets the conversion ready flag and releases a latched ALERT, CRITICAL or WARNING
+             pin, so this is the call to make after the pin has signalled. On the INA3221 the
+             critical flags of channels 1-3 are bits 9-7, the summation flag is bit 6, the warning
+             flags are bits 5-3 and bit 2 is set while the power is valid
+  @param[in] deviceNumber to read
+  @return    register value, 0 for devices without one
+  */
+  inaDet        scratch;
+  const inaDet *dev = descriptor(deviceNumber, scratch);
+  if (dev == nullptr) return 0;
+  uint8_t reg;
+  switch (dev->type) {
+    case INA226:
+    case INA230:
+    case INA231:
+    case INA260: reg = INA_MASK_ENABLE_REGISTER; break;
+    case INA228: reg = INA228_DIAG_ALERT_REGISTER; break;
+    case INA3221_0:
+    case INA3221_1:
+    case INA3221_2: reg = INA3221_MASK_REGISTER; break;
+    default: return 0;  // No flags
+  }  // of switch type
+  lockBus(dev->busAddress, true);
+  uint16_t flags = readWord(reg, dev->busAddress);
+  if (reg != INA228_DIAG_ALERT_REGISTER) {
+    shadowRegister(INA_SHADOW_MASK, dev->busAddress, flags, true);
+  }  // if-then mask/enable register
+  lockBus(dev->busAddress, false);
+  return flags;
+}  // of method getAlertFlags()
+uint8_t INA_Class::identifyAlertingDevice(uint16_t &flags, const uint8_t bus) const {
+  /*!
+  @brief     Finds the device pulling a shared ALERT line low with the SMBus Alert Response Address
+  @details   When the ALERT pins of several devices are wired together, one read of the Alert
+             Response Address returns the I2C address of an alerting device, the lowest one if
+             several are alerting. That address is looked up in the device table and only that
+             device's flags are read with getAlertFlags(), which also releases a latched pin. The
+             cost is therefore the same whatever the number of devices: the Alert Response read
+             plus the flag read, with a pointer write before it unless the device's register
+             pointer is already at its flag register. This does I2C traffic and waits for it, so
+             it must not be called from an interrupt handler: let the handler only note the alert
+             (e.g. with flagConversion() or a flag of its own) and call this from "loop()" or a
+             task. Calling it until it returns UINT8_MAX finds all alerting devices. Behind a mux
+             the response comes from the channel selected last, so the device on that channel is
+             returned. The INA219 and INA3221 don't respond to the Alert Response Address
+  @param[out] flags alert flags of the device found, see getAlertFlags(), 0 if none was found
+  @param[in] bus I2C bus to query (Optional, 0 for "Wire" or the bus number from addBus())
+  @return    number of the alerting device, UINT8_MAX if no known device responded
+  */
+  flags = 0;
+  if (bus >= _busCount) return UINT8_MAX;  // No such bus
+  const uint16_t segment = bus ? INA_BUS_FLAG : 0;
+  lockBus(segment, true);
+  TwoWire &wireBus = wire(segment);
+  uint8_t  address = UINT8_MAX;  // No device responded
+  if (wireBus.requestFrom(INA_ALERT_RESPONSE_ADDRESS, (uint8_t)1) == 1) {
+    address = (uint8_t)wireBus.read() >> 1;  // 7 bit address of the alerting device
+  }  // if-then a device responded
+  lockBus(segment, false);
+  if (address == UINT8_MAX) return UINT8_MAX;
+  for (uint8_t i = 0; i < _DeviceCount; i++) {  // Look the address up
+    inaDet        scratch;
+    const inaDet *dev = descriptor(i, scratch);
+    if ((dev->busAddress & (INA_ADDRESS_MASK | INA_BUS_FLAG)) != (segment | address)) continue;
+    if (dev->busAddress >> 8 && !channelSelected(dev->busAddress)) continue;  // Other mux channel
+    flags = getAlertFlags(i);
+    return i;
+  }  // for-next each device
+  return UINT8_MAX;  // Not a device found by begin()
+}  // of method identifyAlertingDevice()
+bool INA_Class::setCriticalLimit(const int32_t microAmps, const uint8_t deviceNumber,
+                                 const bool latch) {
+  /*!
+  @brief     Sets the current above which an INA3221 channel asserts the CRITICAL pin
+  @details   The limit is compared with every shunt voltage conversion of the channel, so an
+             overcurrent is detected by the device itself without the channel being read. The
+             current is converted to the shunt voltage with the channel's shunt resistance and
+             clamped to the +-163.8mV range of the register
+  @param[in] microAmps limit in microamps
+  @param[in] deviceNumber to set (Optional, when not set all INA3221 channels are set)
+  @param[in] latch true to keep the pin asserted until getAlertFlags() is called. This setting
+             applies to all 3 channels of the device
+  @return    "true" if all devices set are INA3221 channels
+  */
+  return setChannelLimit(INA3221_CRITICAL_REGISTER, INA3221_CEN_BIT, microAmps, deviceNumber,
+                         latch);
+}  // of method setCriticalLimit()
+bool INA_Class::setWarningLimit(const int32_t microAmps, const uint8_t deviceNumber,
+                                const bool latch) {
+  /*!
+  @brief     Sets the current above which an INA3221 channel asserts the WARNING pin
+  @details   As setCriticalLimit(), but the limit is compared with the averaged shunt voltage
+  @param[in] microAmps limit in microamps
+  @param[in] deviceNumber to set (Optional, when not set all INA3221 channels are set)
+  @param[in] latch true to keep the pin asserted until getAlertFlags() is called. This setting
+             applies to all 3 channels of the device
+  @return    "true" if all devices set are INA3221 channels
+  */
+  return setChannelLimit(INA3221_WARNING_REGISTER, INA3221_WEN_BIT, microAmps, deviceNumber,
+                         latch);
+}  // of method setWarningLimit()
+int32_t INA_Class::getCriticalLimit(const uint8_t deviceNumber) const {
+  /*!
+  @brief     Returns the critical limit of an INA3221 channel, see setCriticalLimit()
+  @param[in] deviceNumber to read
+  @return    limit in microamps, 0 if the device isn't an INA3221 channel
+  */
+  return getChannelLimit(INA3221_CRITICAL_REGISTER, deviceNumber);
+}  // of method getCriticalLimit()
+int32_t INA_Class::getWarningLimit(const uint8_t deviceNumber) const {
+  /*!
+  @brief     Returns the warning limit of an INA3221 channel, see setWarningLimit()
+  @param[in] deviceNumber to read
+  @return    limit in microamps, 0 if the device isn't an INA3221 channel
+  */
+  return getChannelLimit(INA3221_WARNING_REGISTER, deviceNumber);
+}  // of method getWarningLimit()
+bool INA_Class::setChannelLimit(const uint8_t reg, const uint8_t latchBit, const int32_t microAmps,
+                                const uint8_t deviceNumber, const bool latch) {
+  /*! @brief     Writes the critical or warning limit of INA3221 channels
+      @param[in] reg limit register of channel 1
+      @param[in] latchBit mask/enable bit latching the flags of this limit
+      @param[in] microAmps limit in microamps
+      @param[in] deviceNumber device to set, UINT8_MAX for all
+      @param[in] latch true to latch the flags
+      @return    "true" if all devices set are INA3221 channels */
+  bool returnCode = true;
+  for (uint8_t i = 0; i < _DeviceCount; i++) {  // Loop for each device found
+    if (deviceNumber != UINT8_MAX && deviceNumber % _DeviceCount != i) continue;
+    inaDet        scratch;
+    const inaDet *dev = descriptor(i, scratch);
+    if (dev->type < INA3221_0 || dev->type > INA3221_2) {
+      returnCode = false;
+      continue;
+    }  // if-then not an INA3221 channel
+    writeWord(reg + 2 * (dev->type - INA3221_0), (uint16_t)(shuntLimit(*dev, microAmps, 4095) * 8),
+              dev->busAddress);  // 3 unused LSB
+    writeMaskControl(*dev, latch ? 0 : 1 << latchBit, latch ? 1 << latchBit : 0);
+  }  // for-next each device
+  return returnCode;
+}  // of method setChannelLimit()
+int32_t INA_Class::getChannelLimit(const uint8_t reg, const uint8_t deviceNumber) const {
+  /*! @brief     Reads the critical or warning limit of an INA3221 channel
+      @param[in] reg limit register of channel 1
+      @param[in] deviceNumber device to read
+      @return    limit in microamps, 0 if the device isn't an INA3221 channel */
+  inaDet        scratch;
+  const inaDet *dev = descriptor(deviceNumber, scratch);
+  if (dev == nullptr || dev->type < INA3221_0 || dev->type > INA3221_2) return 0;
+  lockBus(dev->busAddress, true);
+  int16_t limit = readWord(reg + 2 * (dev->type - INA3221_0), dev->busAddress);
+  lockBus(dev->busAddress, false);
+  return scale(*dev, INA_ROLE_CURRENT, limit / 8);  // 3 unused LSB
+}  // of method getChannelLimit()
+int32_t INA_Class::shuntLimit(const inaDet &dev, const int32_t microAmps, const int16_t largest) {
+  /*! @brief     Converts a current to INA3221 shunt voltage LSBs using the channel's shunt
+      @param[in] dev descriptor of the channel
+      @param[in] microAmps current in microamps
+      @param[in] largest largest value the register holds
+      @return    value in 40uV LSBs, clamped to -"largest" - 1 to "largest" */
+  int64_t limit = (int64_t)microAmps * dev.microOhmR / ((int64_t)dev.shuntVoltage_LSB * 100000);
+  if (limit > largest) return largest;
+  if (limit < -largest - 1) return -largest - 1;
+  return (int32_t)limit;
+}  // of method shuntLimit()
+void INA_Class::writeMaskControl(const inaDet &dev, const uint16_t clear,
+                                 const uint16_t set) const {
+  /*! @brief     Changes the writable bits of an INA3221 mask/enable register
+      @details   The shadowed register is used, so the flags are only reset by a read if its value
+                 isn't known. Unchanged values aren't written
+      @param[in] dev descriptor of one of the device's channels
+      @param[in] clear bits to clear
+      @param[in] set bits to set */
+  uint16_t mask  = readShadowed(INA_SHADOW_MASK, INA3221_MASK_REGISTER, dev.busAddress);
+  uint16_t value = (mask & INA3221_MASK_CONTROL & ~clear) | set;  // Flags are read-only
+  if (value == (mask & INA3221_MASK_CONTROL)) return;             // Shadow may hold flags too
+  writeShadowed(INA_SHADOW_MASK, INA3221_MASK_REGISTER, value, dev.busAddress);
+}  // of method writeMaskControl()
+bool INA_Class::setSummation(const uint8_t channels, const int32_t microAmps,
+                             const uint8_t deviceNumber) {
+  /*!
+  @brief     Selects the INA3221 channels added up in the shunt-voltage sum and sets its limit
+  @details   The device adds up the shunt voltages of the selected channels after each conversion
+             cycle, and asserts the CRITICAL pin when the sum exceeds the limit. The sum is only a
+             current when the channels have the same shunt resistance, as set by begin(). The
+             total current is then read with getSummedMicroAmps() in one register read
+  @param[in] channels bit 0 for channel 1, bit 1 for channel 2 and bit 2 for channel 3, 0 to
+             switch the summation off
+  @param[in] microAmps limit of the sum in microamps, clamped to the +-655.3mV range of the
+             register
+  @param[in] deviceNumber any channel of the device (Optional, when not set all INA3221 are set)
+  @return    "true" if all devices set are INA3221 channels
+  */
+  bool     returnCode  = true;
+  uint16_t lastAddress = UINT16_MAX;  // The channels of an INA3221 are numbered consecutively
+  uint16_t sumChannels = 0;           // SCC bits of the mask/enable register
+  for (uint8_t c = 0; c < 3; c++) {
+    if (bitRead(channels, c)) bitSet(sumChannels, INA3221_SCC1_BIT - c);
+  }  // for-next each channel
+  for (uint8_t i = 0; i < _DeviceCount; i++) {  // Loop for each device found
+    if (deviceNumber != UINT8_MAX && deviceNumber % _DeviceCount != i) continue;
+    inaDet        scratch;
+    const inaDet *dev = descriptor(i, scratch);
+    if (dev->type < INA3221_0 || dev->type > INA3221_2) {
+      returnCode = false;
+      continue;
+    }  // if-then not an INA3221 channel
+    if (dev->busAddress == lastAddress) continue;  // Package already written
+    lastAddress = dev->busAddress;
+    writeWord(INA3221_SUM_LIMIT_REGISTER, (uint16_t)(shuntLimit(*dev, microAmps, 16383) * 2),
+              dev->busAddress);  // 1 unused LSB
+    writeMaskControl(*dev, 7 << (INA3221_SCC1_BIT - 2), sumChannels);
+  }  // for-next each device
+  return returnCode;
+}  // of method setSummation()
+int32_t INA_Class::getSummedMicroAmps(const uint8_t deviceNumber) const {
+  /*!
+  @brief     Returns the total current of the INA3221 channels selected with setSummation()
+  @details   One register is read instead of the shunt voltage of each channel. The sum is
+             converted with the shunt resistance of the channel given
+  @param[in] deviceNumber any channel of the device
+  @return    sum of the channel currents in microamps, 0 if the device isn't an INA3221 channel
+  */
+  inaDet        scratch;
+  const inaDet *dev = descriptor(deviceNumber, scratch);
+  if (dev == nullptr || dev->type < INA3221_0 || dev->type > INA3221_2) return 0;
+  lockBus(dev->busAddress, true);
+  int16_t sum = readWord(INA3221_SUM_REGISTER, dev->busAddress);
+  lockBus(dev->busAddress, false);
+  return scale(*dev, INA_ROLE_CURRENT, sum / 2);  // 1 unused LSB
+}  // of method getSummedMicroAmps()
+bool INA_Class::setPowerValidLimits(const uint16_t upperMilliVolts, const uint16_t lowerMilliVolts,
+                                    const uint8_t deviceNumber) {
+  /*!
+  @brief     Sets the bus voltages between which the INA3221 PV pin changes state
+  @details   The PV pin goes high once the bus voltages of all enabled channels have risen above
+             the upper limit, and low again when one of them falls below the lower limit. The
+             state is also flag bit 2 of getAlertFlags()
+  @param[in] upperMilliVolts upper limit in millivolts, the default is 10000
+  @param[in] lowerMilliVolts lower limit in millivolts, the default is 9000
+  @param[in] deviceNumber any channel of the device (Optional, when not set all INA3221 are set)
+  @return    "true" if all devices set are INA3221 channels
+  */
+  bool     returnCode  = true;
+  uint16_t lastAddress = UINT16_MAX;  // The channels of an INA3221 are numbered consecutively
+  for (uint8_t i = 0; i < _DeviceCount; i++) {  // Loop for each device found
+    if (deviceNumber != UINT8_MAX && deviceNumber % _DeviceCount != i) continue;
+    inaDet        scratch;
+    const inaDet *dev = descriptor(i, scratch);
+    if (dev->type < INA3221_0 || dev->type > INA3221_2) {
+      returnCode = false;
+      continue;
+    }  // if-then not an INA3221 channel
+    if (dev->busAddress == lastAddress) continue;  // Package already written
+    lastAddress = dev->busAddress;
+    uint32_t upper = (uint32_t)upperMilliVolts * 100 / dev->busVoltage_LSB;
+    uint32_t lower = (uint32_t)lowerMilliVolts * 100 / dev->busVoltage_LSB;
+    writeWord(INA3221_PV_UPPER_REGISTER, (uint16_t)((upper > 4095 ? 4095 : upper) * 8),
+              dev->busAddress);  // 3 unused LSB
+    writeWord(INA3221_PV_LOWER_REGISTER, (uint16_t)((lower > 4095 ? 4095 : lower) * 8),
+              dev->busAddress);
+  }  // for-next each device
+  return returnCode;
+}  // of method setPowerValidLimits()
+bool INA_Class::setChannelEnabled(const uint8_t deviceNumber, const bool enabled) {
+  /*!
+  @brief     Switches the conversions of an INA3221 channel on or off
+  @details   The INA3221 converts its enabled channels one after the other, so each channel
+             switched off shortens the conversion cycle by a third of the 3 channel time. The
+             cycle estimates of nextReadyAt() and waitForConversion() follow the setting. A
+             channel switched off keeps its last result, which is what reading it returns until it
+             is switched on again. All channels are on after begin()
+  @param[in] deviceNumber INA3221 channel to switch
+  @param[in] enabled true to convert the channel, false to skip it
+  @return    "true" if the device is an INA3221 channel
+  */
+  if (_DeviceCount == 0) return false;  // No devices
+  inaDet        scratch;
+  const inaDet *dev = descriptor(deviceNumber % _DeviceCount, scratch);
+  if (dev->type < INA3221_0 || dev->type > INA3221_2) return false;
+  uint16_t configRegister = currentConfig(dev->busAddress);
+  uint16_t newRegister    = configRegister;
+  bitWrite(newRegister, INA3221_CH1EN_BIT - (dev->type - INA3221_0), enabled);
+  if (newRegister != configRegister) {
+    writeWord(INA_CONFIGURATION_REGISTER, newRegister, dev->busAddress);  // Restarts the cycle
+  }  // if-then setting changed
+  return true;
+}  // of method setChannelEnabled()
+bool INA_Class::getChannelEnabled(const uint8_t deviceNumber) const {
+  /*!
+  @brief     Returns whether an INA3221 channel is converted, see setChannelEnabled()
+  @param[in] deviceNumber INA3221 channel to check
+  @return    "true" if the channel is converted, "false" if not or not an INA3221 channel
+  */
+  inaDet        scratch;
+  const inaDet *dev = descriptor(deviceNumber, scratch);
+  if (dev == nullptr || dev->type < INA3221_0 || dev->type > INA3221_2) return false;
+  lockBus(dev->busAddress, true);
+  uint16_t configRegister = currentConfig(dev->busAddress);
+  lockBus(dev->busAddress, false);
+  return bitRead(configRegister, INA3221_CH1EN_BIT - (dev->type - INA3221_0));
+}  // of method getChannelEnabled()
+uint8_t INA_Class::disableUnreadChannels() {
+  /*!
+  @brief     Switches off the INA3221 channels which haven't been read since begin()
+  @details   The library notes which INA3221 channels the getters, readAll(), readAllChannels(),
+             the asynchronous reads and the sampling functions have read. Called once the program
+             has made its first pass over the channels it uses, e.g. at the end of "setup()", this
+             switches off the rest so that the channels in use are converted more often, e.g. 50%
+             more often with 2 of the 3 channels in use. An INA3221 none of whose channels has been
+             read is left as it is, and setChannelEnabled() switches a channel on again
+  @return    number of channels switched off
+  */
+  uint8_t disabled = 0;
+  for (uint8_t i = 0; i < _DeviceCount; i++) {  // Loop for each device found
+    inaDet        scratch;
+    const inaDet *dev = descriptor(i, scratch);
+    if (dev->type < INA3221_0 || dev->type > INA3221_2) continue;
+    const inaSlot *entry = claimSlot(dev->busAddress);
+    if (entry == nullptr || entry->channelsRead == 0) continue;          // Device not in use
+    if (bitRead(entry->channelsRead, dev->type - INA3221_0)) continue;  // Channel in use
+    if (getChannelEnabled(i) && setChannelEnabled(i, false)) disabled++;
+  }  // for-next each device
+  return disabled;
+}  // of method disableUnreadChannels()
 void INA_Class::setAveraging(const uint16_t averages, const uint8_t deviceNumber) {
   /*!
   @brief     sets the hardware averaging for one or all devices
-  @details   Out-of-Range averaging is brought down to the highest allowed value
+  @details   Out-of-Range averaging is brought down to the highest allowed value. To change
+             several settings with one register write use configure() instead
   @param[in] averages Number of  averages to set (0-128)
   @param[in] deviceNumber to reset (Optional, when not set all devices have their averaging changed)
   */
-  uint16_t averageIndex;
-  int16_t  configRegister;
-  for (uint8_t i = 0; i < _DeviceCount; i++)  // Loop for each device found
-  {
-    if (deviceNumber == UINT8_MAX ||
-        deviceNumber % _DeviceCount == i)  // If this device needs setting
-    {
-      readInafromEEPROM(i);                                                // Load EEPROM to struct
-      configRegister = readWord(INA_CONFIGURATION_REGISTER, ina.address);  // Get current register
-      switch (ina.type) {
-        case INA219:
-          if (averages >= 128)
-            averageIndex = 15;
-          else if (averages >= 64)
-            averageIndex = 14;
-          else if (averages >= 32)
-            averageIndex = 13;
-          else if (averages >= 16)
-            averageIndex = 12;
-          else if (averages >= 8)
-            averageIndex = 11;
-          else if (averages >= 4)
-            averageIndex = 10;
-          else if (averages >= 2)
-            averageIndex = 9;
-          else
-            averageIndex = 8;
-          configRegister &= ~INA219_CONFIG_AVG_MASK;  // zero out the averages part
-          configRegister |= averageIndex << 3;        // shift in the SADC averages
-          configRegister |= averageIndex << 7;        // shift in the BADC averages
-          break;
-        case INA226:
-        case INA230:
-        case INA231:
-        case INA3221_0:
-        case INA3221_1:
-        case INA3221_2:
-        case INA260:
-          if (averages >= 1024)
-            averageIndex = 7;
-          else if (averages >= 512)
-            averageIndex = 6;
-          else if (averages >= 256)
-            averageIndex = 5;
-          else if (averages >= 128)
-            averageIndex = 4;
-          else if (averages >= 64)
-            averageIndex = 3;
-          else if (averages >= 16)
-            averageIndex = 2;
-          else if (averages >= 4)
-            averageIndex = 1;
-          else
-            averageIndex = 0;
-          configRegister &= ~INA226_CONFIG_AVG_MASK;  // zero out the averages part
-          configRegister |= averageIndex << 9;        // shift in the averages to reg
-          break;
-      }                                                                    // of switch type
-      writeWord(INA_CONFIGURATION_REGISTER, configRegister, ina.address);  // Save new value
-    }  // of if this device needs to be set
-  }    // for-next each device loop
+  configure(deviceNumber).averaging(averages).apply();
 }  // of method setAveraging()
@@ -94,6 +94,30 @@ Written by Arnd <Arnd@Zanduino.Com> at https://www.github.com/SV-Zanshin
 
 | Version | Date       | Developer   | Comments
 | ------- | ---------- | ----------- | --------
+| 1.2.0   | 2026-10-18 | mohamadxmuhaimin | identifyAlertingDevice() using the SMBus Alert Response
+| 1.2.0   | 2026-10-18 | mohamadxmuhaimin | INA3221 setChannelEnabled(), disableUnreadChannels()
+| 1.2.0   | 2026-10-18 | mohamadxmuhaimin | INA3221 critical, warning, sum and power-valid limits
+| 1.2.0   | 2026-10-18 | mohamadxmuhaimin | setAlert() combining conversion ready and a limit
+| 1.2.0   | 2026-10-18 | mohamadxmuhaimin | Shadowed registers, configure() builder
+| 1.2.0   | 2026-10-18 | mohamadxmuhaimin | Reentrant const read path, setBusLock()
+| 1.2.0   | 2026-10-18 | mohamadxmuhaimin | ESP32 background sampling task, startSamplingTask()
+| 1.2.0   | 2026-10-18 | mohamadxmuhaimin | Devices behind TCA9548A multiplexers with addMux()
+| 1.2.0   | 2026-10-18 | mohamadxmuhaimin | Devices on up to 2 I2C buses with addBus()
+| 1.2.0   | 2026-10-18 | mohamadxmuhaimin | Identify devices by ID registers, skip the search on warm boot
+| 1.2.0   | 2026-10-18 | mohamadxmuhaimin | Software energy and charge integration for all devices
+| 1.2.0   | 2026-10-18 | mohamadxmuhaimin | INA228 calibrated current and power registers and ADCRANGE
+| 1.2.0   | 2026-10-18 | mohamadxmuhaimin | INA228 energy and charge accumulators
+| 1.2.0   | 2026-10-18 | mohamadxmuhaimin | Header-only compile-time INA_Device template in INADevice.h
+| 1.2.0   | 2026-10-18 | mohamadxmuhaimin | Fixed-point conversion factors for cached descriptors
+| 1.2.0   | 2026-10-18 | mohamadxmuhaimin | triggerAll() and snapshotAll() for time-aligned readings
+| 1.2.0   | 2026-10-18 | mohamadxmuhaimin | Interrupt driven background sampling into a ring buffer
+| 1.2.0   | 2026-10-18 | mohamadxmuhaimin | waitForConversion() waits for the expected conversion time
+| 1.2.0   | 2026-10-18 | mohamadxmuhaimin | Asynchronous reads with startRead(), poll() and ready()
+| 1.2.0   | 2026-10-18 | mohamadxmuhaimin | Configurable I2C settle delay and calibrateI2CDelay()
+| 1.2.0   | 2026-10-18 | mohamadxmuhaimin | Skip register pointer writes when the pointer is unchanged
+| 1.2.0   | 2026-10-18 | mohamadxmuhaimin | Added readAllChannels() to read all 3 INA3221 channels at once
+| 1.2.0   | 2026-10-18 | mohamadxmuhaimin | Added readAll() to read all 4 values in one call
+| 1.2.0   | 2026-10-18 | mohamadxmuhaimin | Optional RAM table of resolved device descriptors
 | 1.1.2   | 2022-01-16 | Oleg-Sob    | Issue #87. getBusMicroWatts() only returns positive values
 | 1.1.1   | 2021-03-12 | x3mEr       | Issue #79. Documentation Update
 | 1.0.14  | 2020-12-01 | SV-Zanshin  | Issue #72. Allow INA structures to be in memory rather than EEPROM
@@ -164,6 +188,32 @@ Written by Arnd <Arnd@Zanduino.Com> at https://www.github.com/SV-Zanshin
 #ifndef INA__Class_h
 /*! Guard code definition to prevent multiple includes */
 #define INA__Class_h
+#ifndef INA_MAX_BUSES
+  #if defined(__AVR__)
+    #define INA_MAX_BUSES 1  ///< Number of I2C buses one instance can use, see "addBus()"
+  #else
+    #define INA_MAX_BUSES 2  ///< Number of I2C buses one instance can use, see "addBus()"
+  #endif
+#endif
+#ifndef INA_MAX_MUXES
+  #define INA_MAX_MUXES 8  ///< Number of I2C multiplexers one instance can use, see "addMux()"
+#endif
+#if INA_MAX_MUXES > 8
+  #error "INA_MAX_MUXES can be at most 8"
+#endif
+#if defined(ESP32)
+  #include <freertos/FreeRTOS.h>  // Sampling task, see "startSamplingTask()"
+  #include <freertos/task.h>
+#endif
+#if INA_MAX_BUSES == 1
+typedef uint16_t inaSlotMask;  ///< Bit per I2C address slot
+#elif INA_MAX_BUSES == 2
+typedef uint32_t inaSlotMask;  ///< Bit per I2C address slot, the second bus uses bits 16-31
+#else
+  #error "INA_MAX_BUSES can be 1 or 2"
+#endif
+class TwoWire;     // Forward declaration, see Wire.h
+struct inaFactors;  // Forward declaration, see below
 /*! typedef contains a packed bit-level defs of information stored per device */
 typedef struct {
   uint8_t  type : 4;           ///< 0-15        see enumerated "ina_Type" for details
@@ -171,6 +221,8 @@ typedef struct {
   uint32_t address : 7;        ///< 0-127       I2C Address of device
   uint32_t maxBusAmps : 10;    ///< 0-1023      Store initialization value
   uint32_t microOhmR : 20;     ///< 0-1,048,575 Store initialization value
+  uint32_t bus : 1;            ///< 0-1         I2C bus, see "addBus()"
+  uint32_t muxChannel : 7;     ///< 0-64        Mux number * 8 + channel + 1, 0 if not behind one
 } inaEEPROM;                   // of structure
 /*! typedef contains a packed bit-level definition of information stored on a device */
 typedef struct inaDet : inaEEPROM {
@@ -181,9 +233,82 @@ typedef struct inaDet : inaEEPROM {
   uint16_t busVoltage_LSB;            ///< Device dependent LSB factor
   uint32_t current_LSB;               ///< Amperage LSB
   uint32_t power_LSB;                 ///< Wattage LSB
+  uint16_t busAddress;                ///< I2C address, bit 7 set on bus 1, mux channel in bits 8+
+  const inaFactors* factors;          ///< Fixed-point factors if cached, nullptr to divide
   inaDet();                           ///< struct constructor
   inaDet(inaEEPROM& inaEE);           ///< for ina = inaEE; assignment
+  void conversionFactor(const uint8_t role, uint64_t& numerator,
+                        uint32_t& denominator) const;  ///< Conversion factor of a register role
 } inaDet;                             // of structure
+/*! typedef contains the record "begin()" keeps after the descriptors to skip the next search */
+typedef struct {
+  uint16_t    signature;   ///< INA_TOPOLOGY_SIGNATURE if the record is valid
+  inaSlotMask responders;  ///< Bit per I2C address slot which answered
+  uint32_t    channels;    ///< Checksum of the addresses answering behind each mux channel
+  uint8_t     devices;     ///< Number of devices found
+} inaTopology;             // of structure
+/*! typedef contains one complete set of converted measurements as returned by "readAll()" */
+typedef struct {
+  uint16_t busMilliVolts;    ///< Bus voltage in millivolts, see getBusMilliVolts()
+  int32_t  shuntMicroVolts;  ///< Shunt voltage in microvolts, see getShuntMicroVolts()
+  int32_t  busMicroAmps;     ///< Bus current in microamps, see getBusMicroAmps()
+  int64_t  busMicroWatts;    ///< Bus power in microwatts, see getBusMicroWatts()
+} inaReading;                // of structure
+/*! typedef contains the integrated values of one device as returned by "snapshotIntegral()" */
+typedef struct {
+  int64_t  microWattHours;  ///< Energy, trapezoidal integral of the bus microwatts
+  int64_t  microAmpHours;   ///< Charge, trapezoidal integral of the bus microamps
+  int64_t  minMicroWatts;   ///< Lowest bus power seen
+  int64_t  maxMicroWatts;   ///< Highest bus power seen
+  int64_t  meanMicroWatts;  ///< Mean of the bus power of the readings which included it
+  uint64_t elapsedMicros;   ///< Time integrated over
+  uint32_t readings;        ///< Number of readings integrated
+} inaIntegral;              // of structure
+/*! typedef contains the running state of the integration of one device, see "integrate()" */
+typedef struct {
+  int64_t  energyHours;     ///< Whole microwatt hours
+  int64_t  energyPart;      ///< Remainder in microwatt microseconds * 2
+  int64_t  chargeHours;     ///< Whole microamp hours
+  int64_t  chargePart;      ///< Remainder in microamp microseconds * 2
+  int64_t  powerSum;        ///< Sum of the bus power of all readings, for the mean
+  int64_t  minMicroWatts;   ///< Lowest bus power seen
+  int64_t  maxMicroWatts;   ///< Highest bus power seen
+  int64_t  lastMicroWatts;  ///< Bus power of the previous reading which included the power
+  int32_t  lastMicroAmps;   ///< Bus current of the previous reading which included the current
+  uint32_t lastPowerMicros; ///< micros() value of "lastMicroWatts"
+  uint32_t lastAmpsMicros;  ///< micros() value of "lastMicroAmps"
+  uint32_t lastMicros;      ///< micros() value of the previous reading
+  uint64_t elapsedMicros;   ///< Time integrated over
+  uint32_t readings;        ///< Number of readings seen, 0 after a reset
+  uint32_t powerReadings;   ///< Number of readings which included the power
+  uint32_t ampsReadings;    ///< Number of readings which included the current
+} inaIntegrator;            // of structure
+/*! Function called by "poll()" when an asynchronous read started with "startRead()" completes */
+typedef void (*inaCallback)(const uint8_t deviceNumber, const uint8_t what,
+                            const inaReading& reading);
+/*! Function called around the I2C traffic of a read to arbitrate a bus, see "setBusLock()" */
+typedef void (*inaBusLock)(const uint8_t bus, const bool lock);
+/*! typedef contains the state of one asynchronous read, see "startRead()" and "poll()" */
+typedef struct {
+  uint8_t     deviceNumber;   ///< Device being read
+  uint16_t    address;        ///< I2C address of the device, see "inaDet::busAddress"
+  uint8_t     what;           ///< Combination of "ina_Read" values requested
+  uint8_t     state;          ///< See enumerated "ina_AsyncState"
+  uint16_t    roles;          ///< Registers still to be read, see "registersNeeded()"
+  uint8_t     registers[5];   ///< Register address for each register role
+  int32_t     raw[5];         ///< Raw register value for each register role
+  uint32_t    since;          ///< micros() value of the last write, for the settle delay
+  inaReading  reading;        ///< Converted result
+  inaCallback callback;       ///< Function to call on completion or nullptr
+} inaRequest;                 // of structure
+/*! typedef contains the ALERT pin settings of a device, see "setAlert()" */
+typedef struct {
+  uint8_t limitFunction;    ///< Limit compared with each conversion, see "ina_Limit"
+  int32_t limit;            ///< Microvolts (shunt), millivolts (bus) or milliwatts (power)
+  bool    conversionReady;  ///< Also assert the pin when a conversion has finished
+  bool    latch;            ///< Keep the pin asserted until the mask/enable register is read
+  bool    activeHigh;       ///< Assert the pin by driving it high rather than low
+} inaAlert;                 // of structure
 /*! Enumerated list detailing the names of all supported INA devices. The INA3221 is stored
     as 3 distinct devices each with their own enumerated type. */
 enum ina_Type {
@@ -209,6 +334,33 @@ enum ina_Mode {
   INA_MODE_CONTINUOUS_BUS,    ///< Continuous bus, no shunt
   INA_MODE_CONTINUOUS_BOTH    ///< Both continuous, default value
 };                            // of enumerated type
+/*! Enumerated list of the values "startRead()" can read, values may be combined with "|" */
+enum ina_Read {
+  INA_READ_BUS     = 1,  ///< Bus millivolts
+  INA_READ_SHUNT   = 2,  ///< Shunt microvolts
+  INA_READ_CURRENT = 4,  ///< Bus microamps
+  INA_READ_POWER   = 8,  ///< Bus microwatts
+  INA_READ_ALL     = 15  ///< All 4 values, as returned by "readAll()"
+};                       // of enumerated type
+/*! Enumerated list of the states an asynchronous read passes through, see "poll()" */
+enum ina_AsyncState {
+  INA_ASYNC_FREE,     ///< Request slot is unused
+  INA_ASYNC_QUEUED,   ///< Waiting for another request on the same device to finish
+  INA_ASYNC_POINTER,  ///< Register pointer has to be written
+  INA_ASYNC_SETTLE,   ///< Waiting for the settle delay after a write
+  INA_ASYNC_READ,     ///< Register has to be read
+  INA_ASYNC_REARM,    ///< Configuration register has to be written to trigger the next conversion
+  INA_ASYNC_DONE      ///< Result is waiting to be fetched with "ready()"
+};                    // of enumerated type
+/*! Enumerated list of the limit functions of the ALERT pin, only one can be active at a time */
+enum ina_Limit {
+  INA_LIMIT_NONE,         ///< No limit, the pin only signals finished conversions if enabled
+  INA_LIMIT_SHUNT_OVER,   ///< Shunt voltage above the limit
+  INA_LIMIT_SHUNT_UNDER,  ///< Shunt voltage below the limit
+  INA_LIMIT_BUS_OVER,     ///< Bus voltage above the limit
+  INA_LIMIT_BUS_UNDER,    ///< Bus voltage below the limit
+  INA_LIMIT_POWER_OVER    ///< Bus power above the limit
+};                        // of enumerated type
 /************************************************************************************************
 ** Declare constants used in the class                                                         **
 ************************************************************************************************/
@@ -219,6 +371,16 @@ const uint32_t INA_I2C_FAST_MODE{400000};         ///< Fast mode
 const uint32_t INA_I2C_FAST_MODE_PLUS{1000000};   ///< Really fast mode
 const uint32_t INA_I2C_HIGH_SPEED_MODE{3400000};  ///< Turbo mode
 #endif
+const uint8_t  INA_FIRST_ADDRESS{0x40};             ///< First possible INA I2C address
+const uint8_t  INA_LAST_ADDRESS{0x4F};              ///< Last possible INA I2C address
+const uint8_t  INA_BUS_FLAG{0x80};                  ///< Set in "busAddress" on the second bus
+const uint8_t  INA_ADDRESS_MASK{0x7F};              ///< 7 bit I2C address part of "busAddress"
+const uint8_t  INA_MUX_FIRST_ADDRESS{0x70};         ///< First possible TCA9548A I2C address
+const uint8_t  INA_MUX_LAST_ADDRESS{0x77};          ///< Last possible TCA9548A I2C address
+const uint8_t  INA_MUX_CHANNELS{8};                 ///< Channels of each TCA9548A
+const uint8_t  INA_MUX_UNKNOWN{0xFF};               ///< Channels selected on a mux aren't known
+const uint8_t  INA_BUS_SLOTS{INA_LAST_ADDRESS - INA_FIRST_ADDRESS + 1};  ///< I2C addresses per bus
+const uint8_t  INA_ADDRESS_SLOTS{INA_BUS_SLOTS * INA_MAX_BUSES};  ///< Address slots on all buses
 const uint8_t  INA_CONFIGURATION_REGISTER{0};       ///< Configuration Register address
 const uint8_t  INA_BUS_VOLTAGE_REGISTER{2};         ///< Bus Voltage Register address
 const uint8_t  INA_POWER_REGISTER{3};               ///< Power Register address
@@ -227,6 +389,8 @@ const uint8_t  INA_MASK_ENABLE_REGISTER{6};         ///< Mask enable Register (s
 const uint8_t  INA_ALERT_LIMIT_REGISTER{7};         ///< Alert Limit Register (some devices)
 const uint8_t  INA_MANUFACTURER_ID_REGISTER{0xFE};  ///< Mfgr ID Register (some devices)
 const uint8_t  INA_DIE_ID_REGISTER{0xFF};           ///< Die ID Register (some devices)
+const uint16_t INA_MANUFACTURER_ID{0x5449};         ///< Manufacturer ID of TI, "TI" in ASCII
+const uint16_t INA_TOPOLOGY_SIGNATURE{0x4954};      ///< Marks a valid topology record in EEPROM
 const uint16_t INA_RESET_DEVICE{0x8000};            ///< Write to config to reset device
 const uint16_t INA_CONVERSION_READY_MASK{0x0080};   ///< Bit 4
 const uint16_t INA_CONFIG_MODE_MASK{0x0007};        ///< Bits 0-3
@@ -237,6 +401,9 @@ const uint8_t  INA_ALERT_BUS_OVER_VOLT_BIT{13};     ///< Register bit
 const uint8_t  INA_ALERT_BUS_UNDER_VOLT_BIT{12};    ///< Register bit
 const uint8_t  INA_ALERT_POWER_OVER_WATT_BIT{11};   ///< Register bit
 const uint8_t  INA_ALERT_CONVERSION_RDY_BIT{10};    ///< Register bit
+const uint8_t  INA_ALERT_POLARITY_BIT{1};           ///< Register bit, ALERT pin active high
+const uint8_t  INA_ALERT_LATCH_BIT{0};              ///< Register bit, ALERT pin latched
+const uint8_t  INA_ALERT_RESPONSE_ADDRESS{0x0C};    ///< SMBus Alert Response Address
 const uint8_t  INA_DEFAULT_OPERATING_MODE{B111};    ///< Default continuous mode
 const uint8_t  INA219_SHUNT_VOLTAGE_REGISTER{1};    ///< INA219 Shunt Voltage Register
 const uint8_t  INA219_CURRENT_REGISTER{4};          ///< INA219 Current Register
@@ -245,9 +412,10 @@ const uint16_t INA219_SHUNT_VOLTAGE_LSB{100};       ///< INA219 LSB in uV *10  1
 const uint16_t INA219_CONFIG_AVG_MASK{0x07F8};      ///< INA219 Bits 3-6, 7-10
 const uint16_t INA219_CONFIG_PG_MASK{0xE7FF};       ///< INA219 Bits 11-12 masked
 const uint16_t INA219_CONFIG_BADC_MASK{0x0780};     ///< INA219 Bits 7-10  masked
-const uint16_t INA219_CONFIG_SADC_MASK{0x0038};     ///< INA219 Bits 3-5
+const uint16_t INA219_CONFIG_SADC_MASK{0x0078};     ///< INA219 Bits 3-6
 const uint8_t  INA219_BRNG_BIT{13};                 ///< INA219 Bit for BRNG in config reg
 const uint8_t  INA219_PG_FIRST_BIT{11};             ///< INA219 1st bit of Programmable Gain
+const uint16_t INA219_CONFIG_DEFAULT{0x399F};       ///< INA219 Power-on configuration
 const uint8_t  INA226_SHUNT_VOLTAGE_REGISTER{1};    ///< INA226 Shunt Voltage Register
 const uint8_t  INA226_CURRENT_REGISTER{4};          ///< INA226 Current Register
 const uint16_t INA226_BUS_VOLTAGE_LSB{125};         ///< INA226 LSB in uV *100 1.25mV
@@ -256,13 +424,26 @@ const uint16_t INA226_CONFIG_AVG_MASK{0x0E00};      ///< INA226 Bits 9-11
 const uint16_t INA226_DIE_ID_VALUE{0x2260};         ///< INA226 Hard-coded Die ID for INA226
 const uint16_t INA226_CONFIG_BADC_MASK{0x01C0};     ///< INA226 Bits 6-8 masked
 const uint16_t INA226_CONFIG_SADC_MASK{0x0038};     ///< INA226 Bits 3-4
+const uint16_t INA226_CONFIG_DEFAULT{0x4127};       ///< INA226, INA230, INA231 Power-on config
 
+const uint8_t  INA228_ADC_CONFIG_REGISTER{1};       ///< INA228 ADC Configuration Register
+const uint16_t INA228_ADC_CONFIG_DEFAULT{0xFB68};   ///< INA228 Power-on ADC configuration
+const uint8_t  INA228_DIAG_ALERT_REGISTER{0xB};     ///< INA228 Diagnostic flags and Alert Register
+const uint8_t  INA228_SHUNT_CAL_REGISTER{2};        ///< INA228 Shunt Calibration Register
+const uint8_t  INA228_ENERGY_REGISTER{9};           ///< INA228 40 bit Energy accumulator
+const uint8_t  INA228_CHARGE_REGISTER{0xA};         ///< INA228 40 bit Charge accumulator
+const uint8_t  INA228_RSTACC_BIT{14};               ///< INA228 Bit to reset the accumulators
+const uint8_t  INA228_MANUFACTURER_ID_REGISTER{0x3E};  ///< INA228 Manufacturer ID Register
 const uint8_t  INA228_DIE_ID_REGISTER{0x3F};        ///< INA228 Device_ID  Register
 const uint16_t INA228_DIE_ID_VALUE{0x2280};         ///< INA228 Hard-coded Die ID for INA228
+const uint16_t INA228_DIE_ID_MASK{0xFFF0};          ///< INA228 Die ID without the revision
 const uint8_t  INA228_BUS_VOLTAGE_REGISTER{0x5};    ///< INA228 Bus Voltage Register
 const uint16_t INA228_BUS_VOLTAGE_LSB{195};           ///< INA228 LSB in uV *100 1953125uV, extra code
 const uint8_t  INA228_SHUNT_VOLTAGE_REGISTER{4};    ///< INA228 Shunt Voltage Register
-const uint8_t  xINA228_CURRENT_REGISTER{4};          ///< INA228 Current Register
+const uint8_t  INA228_CURRENT_REGISTER{7};          ///< INA228 24 bit Current Register
+const uint8_t  INA228_POWER_REGISTER{8};            ///< INA228 24 bit Power Register
+const uint8_t  INA228_ADCRANGE_BIT{4};              ///< INA228 Bit for ADCRANGE in config reg
+const uint32_t INA228_LOW_RANGE_MICROVOLTS{40960};  ///< INA228 Shunt full scale with ADCRANGE set
 const uint16_t xINA228_CONFIG_AVG_MASK{0x0E00};      ///< INA228 Bits 9-11
 const uint16_t xINA228_CONFIG_BADC_MASK{0x01C0};     ///< INA228 Bits 6-8 masked
 const uint16_t xINA228_CONFIG_SADC_MASK{0x0038};     ///< INA228 Bits 3-4
@@ -270,15 +451,98 @@ const uint16_t xINA228_CONFIG_SADC_MASK{0x0038};     ///< INA228 Bits 3-4
 const uint8_t  INA260_SHUNT_VOLTAGE_REGISTER{0};    ///< INA260 Register doesn't exist
 const uint8_t  INA260_CURRENT_REGISTER{1};          ///< INA260 Current Register
 const uint16_t INA260_BUS_VOLTAGE_LSB{125};         ///< INA260 LSB in uV *100 1.25mV
+const uint16_t INA260_DIE_ID_VALUE{0x2270};         ///< INA260 Hard-coded Die ID for INA260
 const uint16_t INA260_CONFIG_BADC_MASK{0x01C0};     ///< INA260 Bits 6-8  masked
 const uint16_t INA260_CONFIG_SADC_MASK{0x0038};     ///< INA260 Bits 3-5  masked
+const uint16_t INA260_CONFIG_DEFAULT{0x6127};       ///< INA260 Power-on configuration
 const uint8_t  INA3221_SHUNT_VOLTAGE_REGISTER{1};   ///< INA3221 Register number 1
 const uint16_t INA3221_BUS_VOLTAGE_LSB{800};        ///< INA3221 LSB in uV *100 8mV
 const uint16_t INA3221_SHUNT_VOLTAGE_LSB{400};      ///< INA3221 LSB in uV *10  40uV
 const uint16_t INA3221_CONFIG_BADC_MASK{0x01C0};    ///< INA3221 Bits 7-10  masked
+const uint16_t INA3221_CONFIG_DEFAULT{0x7127};      ///< INA3221 Power-on configuration
 const uint8_t  INA3221_MASK_REGISTER{0xF};          ///< INA32219 Mask register
-const uint8_t  I2C_DELAY{10};                       ///< Microsecond delay on I2C writes
+const uint8_t  INA3221_CRITICAL_REGISTER{7};        ///< INA3221 Critical limit, +2 per channel
+const uint8_t  INA3221_WARNING_REGISTER{8};         ///< INA3221 Warning limit, +2 per channel
+const uint8_t  INA3221_SUM_REGISTER{0xD};           ///< INA3221 Shunt-voltage sum
+const uint8_t  INA3221_SUM_LIMIT_REGISTER{0xE};     ///< INA3221 Shunt-voltage sum limit
+const uint8_t  INA3221_PV_UPPER_REGISTER{0x10};     ///< INA3221 Power-valid upper limit
+const uint8_t  INA3221_PV_LOWER_REGISTER{0x11};     ///< INA3221 Power-valid lower limit
+const uint16_t INA3221_MASK_CONTROL{0x7C00};        ///< INA3221 Mask bits 10-14 are writable
+const uint8_t  INA3221_SCC1_BIT{14};                ///< INA3221 Channel 1 in sum, 2 and 3 follow
+const uint8_t  INA3221_WEN_BIT{11};                 ///< INA3221 Warning flags latched
+const uint8_t  INA3221_CEN_BIT{10};                 ///< INA3221 Critical flags latched
+const uint8_t  INA3221_CH1EN_BIT{14};               ///< INA3221 Channel 1 enabled, 2 and 3 follow
+const uint16_t INA3221_DIE_ID_VALUE{0x3220};        ///< INA3221 Hard-coded Die ID for INA3221
+const uint8_t  I2C_DELAY{10};                       ///< Default microsecond delay on I2C writes
+const uint8_t  INA_ASYNC_REQUESTS{4};               ///< Asynchronous reads in flight at once
+const uint16_t INA_SAMPLING_STACK{4096};            ///< ESP32 sampling task stack size in bytes
+const uint8_t  INA_ROLE_BUS{0};                     ///< Register role, bus voltage
+const uint8_t  INA_ROLE_SHUNT{1};                   ///< Register role, shunt voltage
+const uint8_t  INA_ROLE_CURRENT{2};                 ///< Register role, current
+const uint8_t  INA_ROLE_POWER{3};                   ///< Register role, power
+const uint8_t  INA_ROLE_CONFIG{4};                  ///< Register role, configuration (re-arm)
+const uint8_t  INA_ROLE_WIDE{8};                    ///< Bit offset of the 24 bit register flags
+const uint8_t  INA_SHADOW_CALIBRATION{0};           ///< Shadowed register, calibration
+const uint8_t  INA_SHADOW_MASK{1};                  ///< Shadowed register, mask/enable
+const uint8_t  INA_SHADOW_LIMIT{2};                 ///< Shadowed register, alert limit
+const uint8_t  INA_SHADOWS{3};                      ///< Number of shadowed registers
+const uint8_t  INA_SLOT_POINTER{0};                 ///< Slot state bit, "inaSlot::pointer" is valid
+const uint8_t  INA_SLOT_CONFIG{1};                  ///< Slot state bit, "inaSlot::config" is valid
+const uint8_t  INA_SLOT_CYCLE{2};                   ///< Slot state bit, "inaSlot::cycleStart" valid
+const uint8_t  INA_SLOT_SHADOW{3};                  ///< Slot state bit of the first shadow
+const uint8_t  INA_SET_MODE{0};                     ///< Builder setting bit, see "inaConfig"
+const uint8_t  INA_SET_AVERAGING{1};                ///< Builder setting bit, averaging
+const uint8_t  INA_SET_BUS_CONVERSION{2};           ///< Builder setting bit, bus conversion time
+const uint8_t  INA_SET_SHUNT_CONVERSION{3};         ///< Builder setting bit, shunt conversion time
 // clang-format on
+/*! typedef contains one raw sample stored by "serviceSamples()", see "beginSampling()" */
+typedef struct {
+  uint32_t timestamp;             ///< micros() value when the sample was read
+  uint8_t  deviceNumber;          ///< Device the sample was read from
+  int32_t  raw[INA_ROLE_CONFIG];  ///< Raw register values indexed by register role
+} inaSample;                      // of structure
+/*! typedef contains what is known about the device at an I2C address slot, see "claimSlot()" */
+typedef struct {
+  uint32_t cycleStart;            ///< micros() value at which the current conversion started
+  uint16_t config;                ///< Configuration register
+  uint16_t shadow[INA_SHADOWS];   ///< Calibration, mask/enable and alert limit registers
+  uint8_t  pointer;               ///< Register pointer
+  uint8_t  state;                 ///< INA_SLOT_* bits, which of the values above are valid
+  uint8_t  channel;               ///< Mux channel the state is for
+  uint8_t  channelsRead;          ///< INA3221 channels read, bit each
+} inaSlot;                        // of structure
+/*! typedef contains the fixed-point conversion factors of a cached descriptor, see "inaDet" */
+typedef struct inaFactors {
+  uint64_t multiplier[INA_ROLE_CONFIG];  ///< Result units per LSB * 2^shift, by register role
+  uint8_t  shift[INA_ROLE_CONFIG];       ///< Fixed-point shift of each multiplier
+  void     fixedPoint(const uint8_t role, const uint64_t numerator,
+                      const uint32_t denominator);  ///< Computes a multiplier and shift pair
+} inaFactors;                            // of structure
+
+class INA_Class;  // Forward declaration, see "inaConfig"
+class inaConfig {
+  /*!
+   * @class   inaConfig
+   * @brief   Configuration settings collected by "INA_Class::configure()" and written by apply()
+   */
+ public:
+  inaConfig &mode(const uint8_t mode);
+  inaConfig &averaging(const uint16_t averages);
+  inaConfig &busConv(const uint32_t convTime);
+  inaConfig &shuntConv(const uint32_t convTime);
+  uint8_t    apply() const;
+
+ private:
+  friend class INA_Class;
+  inaConfig(INA_Class &owner, const uint8_t deviceNumber);
+  INA_Class *_owner;         ///< Instance whose devices are configured
+  uint8_t    _deviceNumber;  ///< Device to configure, UINT8_MAX for all
+  uint8_t    _settings{0};   ///< Bit per setting made, see "INA_SET_MODE" and the following
+  uint8_t    _mode{0};       ///< Operating mode, see "ina_Mode"
+  uint16_t   _averages{0};   ///< Number of averages
+  uint32_t   _busConv{0};    ///< Bus conversion time in microseconds
+  uint32_t   _shuntConv{0};  ///< Shunt conversion time in microseconds
+};  // of inaConfig definition
 
 class INA_Class {
   /*!
@@ -286,26 +550,65 @@ class INA_Class {
    * @brief   Forward definitions for the INA_Class
    */
  public:
-  INA_Class(uint8_t expectedDevices = 0);
+  INA_Class(uint8_t expectedDevices = 0, const bool cacheDescriptors = false);
   ~INA_Class();
   uint8_t     begin(const uint16_t maxBusAmps, const uint32_t microOhmR,
                     const uint8_t deviceNumber = UINT8_MAX);
-  void        setI2CSpeed(const uint32_t i2cSpeed = INA_I2C_STANDARD_MODE) const;
+  uint8_t     addBus(TwoWire &wire);
+  uint8_t     addMux(const uint8_t muxAddress, const uint8_t bus = 0);
+  void        setI2CSpeed(const uint32_t i2cSpeed = INA_I2C_STANDARD_MODE,
+                          const uint8_t  bus      = UINT8_MAX) const;
+  void        setI2CDelay(const uint8_t microSeconds, const uint8_t deviceNumber = UINT8_MAX);
+  uint8_t     getI2CDelay(const uint8_t deviceNumber = 0) const;
+  void        setBusLock(inaBusLock busLock);
+  uint8_t     calibrateI2CDelay(const uint8_t deviceNumber = UINT8_MAX);
   void        setMode(const uint8_t mode, const uint8_t deviceNumber = UINT8_MAX);
   void        setAveraging(const uint16_t averages, const uint8_t deviceNumber = UINT8_MAX);
   void        setBusConversion(const uint32_t convTime, const uint8_t deviceNumber = UINT8_MAX);
   void        setShuntConversion(const uint32_t convTime, const uint8_t deviceNumber = UINT8_MAX);
-  uint16_t    getBusMilliVolts(const uint8_t deviceNumber = 0);
-  uint32_t    getBusRaw(const uint8_t deviceNumber = 0);
-  int32_t     getShuntMicroVolts(const uint8_t deviceNumber = 0);
-  int32_t     getShuntRaw(const uint8_t deviceNumber = 0);
-  int32_t     getBusMicroAmps(const uint8_t deviceNumber = 0);
-  int64_t     getBusMicroWatts(const uint8_t deviceNumber = 0);
-  const char* getDeviceName(const uint8_t deviceNumber = 0);
-  uint8_t     getDeviceAddress(const uint8_t deviceNumber = 0);
+  inaConfig   configure(const uint8_t deviceNumber = UINT8_MAX);
+  uint16_t    getBusMilliVolts(const uint8_t deviceNumber = 0) const;
+  uint32_t    getBusRaw(const uint8_t deviceNumber = 0) const;
+  int32_t     getShuntMicroVolts(const uint8_t deviceNumber = 0) const;
+  int32_t     getShuntRaw(const uint8_t deviceNumber = 0) const;
+  int32_t     getBusMicroAmps(const uint8_t deviceNumber = 0) const;
+  int64_t     getBusMicroWatts(const uint8_t deviceNumber = 0) const;
+  uint64_t    getEnergyMicroJoules(const uint8_t deviceNumber = 0) const;
+  int64_t     getChargeMicroCoulombs(const uint8_t deviceNumber = 0) const;
+  void        resetAccumulators(const uint8_t deviceNumber = UINT8_MAX);
+  bool        readAll(const uint8_t deviceNumber, inaReading &reading) const;
+  bool        readAllChannels(const uint8_t deviceNumber, inaReading readings[3]) const;
+  uint8_t     startRead(const uint8_t deviceNumber, const uint8_t what = INA_READ_ALL,
+                        inaCallback callback = nullptr);
+  bool        poll();
+  bool        ready(const uint8_t request, inaReading &reading);
+  bool        beginSampling(const uint8_t capacity = 16,
+                            const uint8_t what     = INA_READ_BUS | INA_READ_CURRENT);
+  void        flagConversion(const uint8_t deviceNumber = UINT8_MAX);
+  uint8_t     serviceSamples();
+  bool        readSample(inaSample &sample);
+  uint8_t     samplesAvailable() const;
+  uint32_t    getSampleOverruns() const;
+  void        convertSample(const inaSample &sample, inaReading &reading) const;
+  bool        beginIntegration();
+  bool        snapshotIntegral(const uint8_t deviceNumber, inaIntegral &integral) const;
+  void        resetIntegral(const uint8_t deviceNumber = UINT8_MAX);
+  #if defined(ESP32)
+  bool        startSamplingTask(const uint16_t periodMillis, const BaseType_t core = 0,
+                                const UBaseType_t priority = 2);
+  void        stopSamplingTask();
+  uint32_t    latestFrame(inaReading readings[], const uint8_t count, uint32_t &timestamp) const;
+  #endif
+  const char* getDeviceName(const uint8_t deviceNumber = 0) const;
+  uint8_t     getDeviceAddress(const uint8_t deviceNumber = 0) const;
+  uint8_t     getDeviceBus(const uint8_t deviceNumber = 0) const;
+  uint8_t     getDeviceChannel(const uint8_t deviceNumber = 0) const;
   void        reset(const uint8_t deviceNumber = 0);
-  bool        conversionFinished(const uint8_t deviceNumber = 0);
-  void        waitForConversion(const uint8_t deviceNumber = UINT8_MAX);
+  bool        conversionFinished(const uint8_t deviceNumber = 0) const;
+  bool        waitForConversion(const uint8_t deviceNumber = UINT8_MAX, const uint32_t timeout = 0);
+  uint32_t    nextReadyAt(const uint8_t deviceNumber = 0) const;
+  uint8_t     triggerAll();
+  uint8_t     snapshotAll(inaReading readings[], const uint8_t count, uint32_t &timestamp);
   bool        alertOnConversion(const bool alertState, const uint8_t deviceNumber = UINT8_MAX);
   bool        alertOnShuntOverVoltage(const bool alertState, const int32_t milliVolts,
                                       const uint8_t deviceNumber = UINT8_MAX);
@@ -317,23 +620,152 @@ class INA_Class {
                                      const uint8_t deviceNumber = UINT8_MAX);
   bool        alertOnPowerOverLimit(const bool alertState, const int32_t milliAmps,
                                     const uint8_t deviceNumber = UINT8_MAX);
+  bool        setAlert(const inaAlert &alert, const uint8_t deviceNumber = UINT8_MAX);
+  uint16_t    getAlertFlags(const uint8_t deviceNumber = 0) const;
+  uint8_t     identifyAlertingDevice(uint16_t &flags, const uint8_t bus = 0) const;
+  bool        setCriticalLimit(const int32_t microAmps, const uint8_t deviceNumber = UINT8_MAX,
+                               const bool latch = false);
+  bool        setWarningLimit(const int32_t microAmps, const uint8_t deviceNumber = UINT8_MAX,
+                              const bool latch = false);
+  int32_t     getCriticalLimit(const uint8_t deviceNumber = 0) const;
+  int32_t     getWarningLimit(const uint8_t deviceNumber = 0) const;
+  bool        setSummation(const uint8_t channels, const int32_t microAmps,
+                           const uint8_t deviceNumber = UINT8_MAX);
+  int32_t     getSummedMicroAmps(const uint8_t deviceNumber = 0) const;
+  bool        setPowerValidLimits(const uint16_t upperMilliVolts, const uint16_t lowerMilliVolts,
+                                  const uint8_t deviceNumber = UINT8_MAX);
+  bool        setChannelEnabled(const uint8_t deviceNumber, const bool enabled);
+  bool        getChannelEnabled(const uint8_t deviceNumber = 0) const;
+  uint8_t     disableUnreadChannels();
   uint16_t    _EEPROM_offset = 0;  ///< Offset to all EEPROM addresses, GitHub issue #41
   #if defined(ESP32) || defined(ESP8266)
   uint16_t _EEPROM_size = 512;  ///< Default EEPROM reserved space for ESP32 and ESP8266
   #endif
  private:
-  int16_t    readWord(const uint8_t addr, const uint8_t deviceAddress) const;
-  int32_t    read3Bytes(const uint8_t addr, const uint8_t deviceAddress) const;
-  void       writeWord(const uint8_t addr, const uint16_t data, const uint8_t deviceAddress) const;
+  friend class inaConfig;
+  TwoWire   &wire(const uint16_t deviceAddress) const;
+  void       writeMux(const uint8_t mux, const uint8_t channels) const;
+  bool       channelSelected(const uint16_t deviceAddress) const;
+  uint16_t   segmentAddress(const uint8_t segment) const;
+  uint16_t   probeAddresses(const uint16_t segment) const;
+  static uint8_t addressSlot(const uint16_t deviceAddress);
+  static uint8_t slotAddress(const uint8_t slot);
+  void       allocateSlots(const inaSlotMask answering);
+  inaSlot   *claimSlot(const uint16_t deviceAddress) const;
+  int16_t    readWord(const uint8_t addr, const uint16_t deviceAddress) const;
+  int32_t    read3Bytes(const uint8_t addr, const uint16_t deviceAddress) const;
+  uint64_t   read5Bytes(const uint8_t addr, const uint16_t deviceAddress) const;
+  void       writeWord(const uint8_t addr, const uint16_t data, const uint16_t deviceAddress) const;
+  void       readWords(const uint8_t addr, const uint8_t count, uint16_t *words,
+                       const uint16_t deviceAddress) const;
+  void       convertINA3221(const inaDet &dev, const int32_t shuntRaw, const uint32_t busRaw,
+                            inaReading &reading) const;
+  static int64_t scale(const inaDet &dev, const uint8_t role, const int32_t raw);
+  static int64_t fixedScale(const int32_t raw, const uint64_t multiplier, const uint8_t shift);
+  bool       pointerCached(const uint8_t addr, const uint16_t deviceAddress) const;
+  void       cachePointer(const uint8_t addr, const uint16_t deviceAddress, const bool valid) const;
+  uint8_t    settleMicros(const uint16_t deviceAddress) const;
+  void       settle(const uint16_t deviceAddress) const;
+  void       sleepUntil(const uint32_t wakeAt) const;
+  void       shadowConfig(const uint16_t deviceAddress, const uint16_t configRegister,
+                          const bool valid, const bool restarted) const;
+  uint16_t   currentConfig(const uint16_t deviceAddress) const;
+  uint16_t   readShadowed(const uint8_t shadow, const uint8_t addr,
+                          const uint16_t deviceAddress) const;
+  void       writeShadowed(const uint8_t shadow, const uint8_t addr, const uint16_t data,
+                           const uint16_t deviceAddress) const;
+  void       shadowRegister(const uint8_t shadow, const uint16_t deviceAddress,
+                            const uint16_t value, const bool valid) const;
+  static uint16_t configValue(const uint8_t type, uint16_t configRegister,
+                              const inaConfig &config);
+  uint8_t    applyConfig(const inaConfig &config);
+  bool       alertRegisters(const inaDet &dev, const inaAlert &alert, uint16_t &mask,
+                            uint16_t &limit) const;
+  bool       writeAlert(const inaAlert &alert, const uint8_t deviceNumber, const bool keepPin);
+  bool       setChannelLimit(const uint8_t reg, const uint8_t latchBit, const int32_t microAmps,
+                             const uint8_t deviceNumber, const bool latch);
+  int32_t    getChannelLimit(const uint8_t reg, const uint8_t deviceNumber) const;
+  static int32_t shuntLimit(const inaDet &dev, const int32_t microAmps, const int16_t largest);
+  void       writeMaskControl(const inaDet &dev, const uint16_t clear, const uint16_t set) const;
+  void       retrigger(const inaDet &dev) const;
+  void       clearAccumulators(const inaDet &dev) const;
+  bool       conversionReady(const inaDet &dev) const;
+  uint32_t   conversionMicros(const inaDet &dev) const;
+  uint16_t   registersNeeded(const inaDet &dev, const uint8_t what) const;
+  uint8_t    roleRegister(const inaDet &dev, const uint8_t role) const;
+  void       readRegisters(const inaDet &dev, const uint16_t roles, int32_t raw[]) const;
+  void       convertReading(const inaDet &dev, const int32_t raw[], inaReading &reading) const;
+  uint8_t    measure(const uint8_t deviceNumber, const uint8_t what, int32_t raw[],
+                     inaReading &reading) const;
+  static bool rearmNeeded(const inaDet &dev, const uint8_t what);
+  void       advanceRequest(inaRequest &r);
+  void       finishRequest(inaRequest &r);
+  void       integrate(const uint8_t deviceNumber, const inaReading &reading,
+                       const uint32_t timestamp, const uint8_t what) const;
+  static void accumulate(int64_t &hours, int64_t &part, const int64_t sum,
+                         const uint32_t microSeconds);
   void       readInafromEEPROM(const uint8_t deviceNumber);
+  void       loadDescriptor(const uint8_t deviceNumber, inaEEPROM &stored) const;
+  const inaDet *descriptor(const uint8_t deviceNumber, inaDet &scratch) const;
+  static void cacheFactors(inaDet &dev, inaFactors &factors);
+  void       buildDescriptorCache();
+  void       lockBus(const uint16_t deviceAddress, const bool lock) const;
+  void       lockAllBuses(const bool lock) const;
   void       writeInatoEEPROM(const uint8_t deviceNumber);
   void       initDevice(const uint8_t deviceNumber);
-  uint8_t    _DeviceCount{0};         ///< Total number of devices detected
-  uint8_t    _currentINA{UINT8_MAX};  ///< Stores current INA device number
-  uint8_t    _expectedDevices{0};     ///< If 0 use EEPROM, otherwise use RAM for INA structures
-  inaEEPROM* _DeviceArray;            ///< Pointer to dynamic array of devices if not using EEPROM
-  inaEEPROM  inaEE;                   ///< INA device structure
-  inaDet     ina;                     ///< INA device structure
+  uint16_t   calibrationValue() const;
+  void       writeDefaults(const uint8_t type, const uint16_t deviceAddress);
+  uint8_t    identifyDevice(const uint16_t deviceAddress);
+  bool       loadTopology(const uint8_t maxDevices, const inaSlotMask responders,
+                          const uint32_t channels, const uint16_t maxBusAmps,
+                          const uint32_t microOhmR);
+  void       saveTopology(const uint8_t maxDevices, const inaSlotMask responders,
+                          const uint32_t channels) const;
+  #if defined(ESP32)
+  static void samplingTask(void *parameter);
+  #endif
+  uint8_t    triggerSlots(const inaSlotMask addresses, const uint8_t channel,
+                          uint8_t &longestSettle);
+  uint8_t    _DeviceCount{0};           ///< Total number of devices detected
+  uint8_t    _currentINA{UINT8_MAX};    ///< Stores current INA device number
+  uint8_t    _expectedDevices{0};       ///< If 0 use EEPROM, otherwise use RAM for INA structures
+  bool       _cacheDescriptors{false};  ///< If set keep resolved "inaDet" structures in RAM
+  inaEEPROM* _DeviceArray;              ///< Pointer to dynamic array of devices if not using EEPROM
+  inaDet*    _DetailArray{nullptr};     ///< Pointer to dynamic array of resolved device descriptors
+  inaFactors* _FactorArray{nullptr};    ///< Pointer to dynamic array of cached conversion factors
+  mutable inaDet _lastDescriptor;       ///< Last descriptor resolved without the cache
+  mutable uint8_t _lastDevice{UINT8_MAX};  ///< Device of "_lastDescriptor", UINT8_MAX if none
+  inaRequest* _Requests{nullptr};       ///< Pointer to dynamic array of asynchronous read requests
+  inaSlotMask _asyncBusy{0};            ///< Bit per address slot, set while a request is using it
+  inaSample* _Samples{nullptr};         ///< Pointer to dynamic ring buffer of background samples
+  uint8_t    _sampleMask{0};            ///< Ring buffer size - 1
+  uint8_t    _sampleWhat{0};            ///< Values read with each sample, see "ina_Read"
+  volatile uint8_t  _sampleHead{0};     ///< Next entry written by serviceSamples()
+  volatile uint8_t  _sampleTail{0};     ///< Next entry read by readSample()
+  volatile uint32_t _pendingConversions{0};  ///< Bit per device flagged by flagConversion()
+  uint32_t   _sampleOverruns{0};        ///< Samples lost because the buffer was full
+  inaIntegrator* _Integrators{nullptr}; ///< Pointer to dynamic array of integrator states
+  uint8_t    _integratorCount{0};       ///< Number of devices in "_Integrators"
+  inaEEPROM  inaEE;                     ///< INA device structure
+  inaDet     ina;                       ///< INA device structure
+  uint8_t             _i2cDelay[INA_ADDRESS_SLOTS];      ///< Settle delay per address slot
+  inaSlot            *_Slots{nullptr};                  ///< Dynamic array, answering slots only
+  inaSlotMask         _slotMask{0};                     ///< Bit per address slot in "_Slots"
+  TwoWire            *_wires[INA_MAX_BUSES];  ///< I2C buses, the first one is "Wire"
+  uint8_t             _busCount{1};           ///< Number of buses in "_wires"
+  uint8_t             _muxes[INA_MAX_MUXES];  ///< I2C address of each mux, bit 7 set on bus 1
+  mutable uint8_t     _muxSelected[INA_MAX_MUXES];  ///< Channel bits last written to each mux
+  uint8_t             _muxCount{0};                 ///< Number of muxes in "_muxes"
+  inaBusLock          _busLock{nullptr};            ///< Bus arbitration, see setBusLock()
+  #if defined(ESP32)
+  TaskHandle_t      _samplingTask{nullptr};  ///< Task started by startSamplingTask()
+  volatile bool     _samplingStop{false};    ///< Set to make the sampling task end itself
+  TickType_t        _framePeriod{0};         ///< Time between the starts of 2 frames
+  inaReading*       _Frames{nullptr};        ///< 2 frames of "_frameDevices" readings each
+  uint8_t           _frameDevices{0};        ///< Number of devices read in each frame
+  uint32_t          _frameTime[2];           ///< micros() value at which each frame was started
+  volatile uint32_t _frameSequence{0};       ///< Number of frames published, see latestFrame()
+  #endif
   #if defined(__AVR__) || defined(CORE_TEENSY) || defined(ESP32) || defined(ESP8266) || \
       defined(__STM32F1__)
   #else
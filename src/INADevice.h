@@ -0,0 +1,324 @@
+// clang-format off
+/*!
+ @file INADevice.h
+
+ @brief Header-only INA device template for boards with a fixed, known set of devices
+
+ @section INADevice_intro_section Description
+
+ "INA_Class" finds the devices on the I2C bus at runtime, stores a descriptor per device in EEPROM
+ (or RAM) and selects the registers and conversion factors by device type on every call. When the
+ devices on a board are known when the sketch is written, the "INA_Device" template can be used
+ instead. The device type, I2C address, maximum current and shunt resistance are template
+ parameters, so the register addresses, LSB values, shifts, calibration value and fixed-point
+ conversion factors are all compile-time constants. Each read compiles to just the I2C transactions
+ needed plus a constant multiply and shift, there is no descriptor to load and no type dispatch,
+ and only the code for the device types actually used is generated:\n\n
+ @code
+ INA_Device<INA226, 0x40, 4, 20000> battery;  // INA226 at 0x40, 4A maximum, 20mOhm shunt
+ INA_Device<INA3221_1, 0x41, 1, 100000> rail; // 2nd channel of an INA3221 with a 0.1Ohm shunt
+ @endcode
+ The getters return the same values as the "INA_Class" getters of the same name. The INA219,
+ INA226, INA230, INA231, INA260 and the INA3221 channels are supported, the INA228 is not yet.
+ Both can be used in the same sketch, but not for the same device as the template keeps track of
+ the device's register pointer and configuration. The state is kept per I2C address, so the 3
+ channels of an INA3221 can each have their own object.
+
+ @section INADevice_license GNU General Public License v3.0
+
+ This program is free software: you can redistribute it and/or modify it under the terms of the GNU
+ General Public License as published by the Free Software Foundation, either version 3 of the
+ License, or (at your option) any later version. This program is distributed in the hope that it
+ will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for more details. You should
+ have received a copy of the GNU General Public License along with this program. If not, see
+ <http://www.gnu.org/licenses/>.
+
+ @section INADevice_versions Changelog
+
+| Version | Date       | Developer        | Comments
+| ------- | ---------- | ---------------- | --------
+| 1.0.0   | 2026-10-18 | mohamadxmuhaimin | Initial version
+*/
+// clang-format on
+#ifndef INA__Device_h
+/*! Guard code definition to prevent multiple includes */
+#define INA__Device_h
+#include <INA.h>
+#include <Wire.h>
+
+template <uint8_t ADDRESS>
+struct INA_DeviceState {
+  /*!
+   * @struct  INA_DeviceState
+   * @brief   State kept per I2C address, so that the 3 channels of an INA3221 share it
+   */
+  static uint16_t config;   ///< Configuration register as last written
+  static uint8_t  mode;     ///< Operating mode, see "ina_Mode"
+  static uint8_t  pointer;  ///< Register the device points to, UINT8_MAX if unknown
+};                          // of INA_DeviceState definition
+template <uint8_t ADDRESS>
+uint16_t INA_DeviceState<ADDRESS>::config{0};
+template <uint8_t ADDRESS>
+uint8_t INA_DeviceState<ADDRESS>::mode{INA_DEFAULT_OPERATING_MODE};
+template <uint8_t ADDRESS>
+uint8_t INA_DeviceState<ADDRESS>::pointer{UINT8_MAX};
+
+template <ina_Type TYPE, uint8_t ADDRESS, uint16_t MAX_BUS_AMPS = 1,
+          uint32_t MICRO_OHM_R = 100000>
+class INA_Device {
+  /*!
+   * @class   INA_Device
+   * @brief   One INA device with its type, address, maximum current and shunt fixed at compile time
+   */
+  static_assert(TYPE != INA228 && TYPE != INA_UNKNOWN, "INA_Device doesn't support this device");
+  static_assert(ADDRESS >= INA_FIRST_ADDRESS && ADDRESS <= INA_LAST_ADDRESS, "Invalid address");
+
+ public:
+  void begin(const uint8_t mode = INA_DEFAULT_OPERATING_MODE) {
+    /*! @brief     Initializes the device
+        @details   "Wire.begin()" is called, the calibration register is written on devices which
+                   have one and the operating mode is set. The INA219 programmable gain is set for
+                   the maximum shunt voltage just as "INA_Class::begin()" does
+        @param[in] mode operating mode, see "ina_Mode" */
+    Wire.begin();
+    if (isINA219()) {
+      writeWord(INA_CALIBRATION_REGISTER, calibration());
+      State::config = ina219Config();
+    } else {
+      if (isINA226()) writeWord(INA_CALIBRATION_REGISTER, calibration());
+      State::config = readWord(INA_CONFIGURATION_REGISTER);
+    }  // if-then-else an INA219
+    setMode(mode);
+  }  // of method begin()
+  void setMode(const uint8_t mode) {
+    /*! @brief     Sets the operating mode, see "ina_Mode"
+        @param[in] mode operating mode */
+    State::mode   = mode & INA_CONFIG_MODE_MASK;  // Shared by all channels of an INA3221
+    State::config = (State::config & ~INA_CONFIG_MODE_MASK) | State::mode;
+    writeWord(INA_CONFIGURATION_REGISTER, State::config);
+  }  // of method setMode()
+  uint32_t getBusRaw() {
+    /*! @brief     Returns the raw bus voltage reading, in triggered mode the next conversion is
+                   started
+        @return    Raw bus measurement */
+    uint32_t raw = (uint16_t)readWord(busRegister()) >> busRawShift();
+    if (triggered() && (State::mode & 2)) retrigger();
+    return raw;
+  }  // of method getBusRaw()
+  int32_t getShuntRaw() {
+    /*! @brief     Returns the raw shunt reading, in triggered mode the next conversion is started
+        @return    Raw shunt reading */
+    int32_t raw;
+    if (TYPE == INA260) {
+      raw = getBusMicroAmps() / 200 / 1000;  // 2mOhm resistor, apply Ohm's law
+    } else {
+      raw = readWord(shuntRegister()) >> shuntRawShift();  // Shifts in sign bits
+    }  // if-then-else built-in shunt
+    if (triggered() && (State::mode & 1)) retrigger();
+    return raw;
+  }  // of method getShuntRaw()
+  uint16_t getBusMilliVolts() {
+    /*! @brief     Returns the bus voltage in millivolts
+        @return    bus millivolts */
+    return toMilliVolts(getBusRaw());
+  }  // of method getBusMilliVolts()
+  int32_t getShuntMicroVolts() {
+    /*! @brief     Returns the shunt voltage in microvolts
+        @return    shunt microvolts */
+    if (TYPE == INA260) {
+      int32_t microVolts = getBusMicroAmps() / 200;  // 2mOhm resistor, apply Ohm's law
+      if (triggered() && (State::mode & 1)) retrigger();
+      return microVolts;
+    }  // if-then built-in shunt
+    return toMicroVolts(getShuntRaw());
+  }  // of method getShuntMicroVolts()
+  int32_t getBusMicroAmps() {
+    /*! @brief     Returns the bus current in microamps
+        @return    bus microamps */
+    if (isINA3221()) return toMicroAmps(getShuntRaw());  // No current register
+    return toMicroAmps(readWord(currentRegister()));
+  }  // of method getBusMicroAmps()
+  int64_t getBusMicroWatts() {
+    /*! @brief     Returns the bus power in microwatts, negative when the shunt voltage is negative
+        @return    bus microwatts */
+    if (isINA3221()) {
+      int32_t shuntRaw = getShuntRaw();  // No power register, use the raw product
+      return toMicroWatts(shuntRaw * (int32_t)getBusRaw());
+    }  // if-then an INA3221
+    int64_t microWatts = toMicroWatts(readWord(INA_POWER_REGISTER));
+    if (getShuntRaw() < 0) microWatts = -microWatts;  // Invert if negative voltage
+    return microWatts;
+  }  // of method getBusMicroWatts()
+  void readAll(inaReading &reading) {
+    /*! @brief     Returns all 4 values with each register read once, see "INA_Class::readAll()"
+        @param[out] reading structure which receives the converted values */
+    uint32_t busRaw         = (uint16_t)readWord(busRegister()) >> busRawShift();
+    reading.busMilliVolts   = toMilliVolts(busRaw);
+    if (isINA3221()) {
+      int32_t shuntRaw        = readWord(shuntRegister()) >> shuntRawShift();
+      reading.shuntMicroVolts = toMicroVolts(shuntRaw);
+      reading.busMicroAmps    = toMicroAmps(shuntRaw);
+      reading.busMicroWatts   = toMicroWatts(shuntRaw * (int32_t)busRaw);
+    } else {
+      reading.busMicroAmps  = toMicroAmps(readWord(currentRegister()));
+      reading.busMicroWatts = toMicroWatts(readWord(INA_POWER_REGISTER));
+      if (TYPE == INA260) {
+        reading.shuntMicroVolts = reading.busMicroAmps / 200;  // 2mOhm resistor, Ohm's law
+        if (reading.busMicroAmps / 200 / 1000 < 0) reading.busMicroWatts = -reading.busMicroWatts;
+      } else {
+        int32_t shuntRaw        = readWord(shuntRegister());
+        reading.shuntMicroVolts = toMicroVolts(shuntRaw);
+        if (shuntRaw < 0) reading.busMicroWatts = -reading.busMicroWatts;
+      }  // if-then-else built-in shunt
+    }    // if-then-else an INA3221
+    if (triggered() && (State::mode & 3)) retrigger();
+  }  // of method readAll()
+  bool conversionFinished() {
+    /*! @brief     Reads and resets the conversion ready flag
+        @return    "true" if a conversion has finished since the flag was last read */
+    if (isINA219()) {
+      bool ready = readWord(INA_BUS_VOLTAGE_REGISTER) & 2;  // Bit 2 set denotes ready
+      readWord(INA_POWER_REGISTER);                         // Resets the "ready" bit
+      return ready;
+    }  // if-then an INA219
+    if (isINA3221()) return readWord(INA3221_MASK_REGISTER) & 1;
+    return readWord(INA_MASK_ENABLE_REGISTER) & 8;
+  }  // of method conversionFinished()
+
+ private:
+  static constexpr bool isINA219() { return TYPE == INA219; }
+  static constexpr bool isINA226() { return TYPE == INA226 || TYPE == INA230 || TYPE == INA231; }
+  static constexpr bool isINA3221() {
+    return TYPE == INA3221_0 || TYPE == INA3221_1 || TYPE == INA3221_2;
+  }
+  static constexpr uint8_t channel() { return isINA3221() ? TYPE - INA3221_0 : 0; }
+  static constexpr uint8_t busRegister() { return INA_BUS_VOLTAGE_REGISTER + 2 * channel(); }
+  static constexpr uint8_t shuntRegister() {
+    return isINA3221()  ? INA3221_SHUNT_VOLTAGE_REGISTER + 2 * channel()
+           : isINA219() ? INA219_SHUNT_VOLTAGE_REGISTER
+                        : INA226_SHUNT_VOLTAGE_REGISTER;
+  }
+  static constexpr uint8_t currentRegister() {
+    return TYPE == INA260 ? INA260_CURRENT_REGISTER
+                          : (isINA219() ? INA219_CURRENT_REGISTER : INA226_CURRENT_REGISTER);
+  }
+  static constexpr uint8_t busRawShift() { return isINA219() || isINA3221() ? 3 : 0; }  // Unused
+  static constexpr uint8_t shuntRawShift() { return isINA3221() ? 3 : 0; }               // LSB
+  static constexpr uint16_t busLSB() {
+    return isINA219() ? INA219_BUS_VOLTAGE_LSB
+                      : (isINA3221() ? INA3221_BUS_VOLTAGE_LSB
+                                     : (TYPE == INA260 ? INA260_BUS_VOLTAGE_LSB
+                                                       : INA226_BUS_VOLTAGE_LSB));
+  }
+  static constexpr uint16_t shuntLSB() {
+    return isINA219() ? INA219_SHUNT_VOLTAGE_LSB
+                      : (isINA3221() ? INA3221_SHUNT_VOLTAGE_LSB
+                                     : (TYPE == INA260 ? 0 : INA226_SHUNT_VOLTAGE_LSB));
+  }
+  static constexpr uint32_t currentLSB() {  // in nA, as in "inaDet"
+    return TYPE == INA260 ? 1250000
+                          : (isINA3221() ? 0 : (uint64_t)MAX_BUS_AMPS * 1000000000 / 32767);
+  }
+  static constexpr uint32_t powerLSB() {
+    return TYPE == INA260 ? 10000000
+                          : (isINA3221() ? 0 : (isINA219() ? 20 : 25) * currentLSB());
+  }
+  static constexpr uint16_t calibration() {
+    return (uint64_t)(isINA219() ? 409600000 : 51200000) /
+           ((uint64_t)currentLSB() * MICRO_OHM_R / 100000);
+  }
+  static constexpr uint16_t ina219Config() {  // Programmable gain for the maximum shunt voltage
+    return (0x399F & INA219_CONFIG_PG_MASK) | (1 << INA219_BRNG_BIT) |
+           ((uint16_t)(MAX_BUS_AMPS * MICRO_OHM_R / 1000) <= 40
+                ? 0
+                : (uint16_t)(MAX_BUS_AMPS * MICRO_OHM_R / 1000) <= 80
+                      ? 1
+                      : (uint16_t)(MAX_BUS_AMPS * MICRO_OHM_R / 1000) <= 160 ? 2 : 3)
+               << INA219_PG_FIRST_BIT;
+  }
+  static constexpr uint8_t fixedShift(const uint64_t quotient, const uint64_t remainder,
+                                      const uint32_t denominator, const uint8_t shift) {
+    /* Same long division as "inaDet::fixedPoint()", so the results are identical */
+    return quotient >= ((uint64_t)1 << 62)
+               ? shift
+               : fixedShift(quotient << 1 | (remainder << 1 >= denominator),
+                            (remainder << 1) % denominator, denominator, shift + 1);
+  }
+  static constexpr uint64_t fixedRoundUp(const uint64_t quotient, const uint64_t remainder,
+                                         const uint32_t denominator) {
+    return quotient >= ((uint64_t)1 << 62)
+               ? quotient + (remainder != 0)
+               : fixedRoundUp(quotient << 1 | (remainder << 1 >= denominator),
+                              (remainder << 1) % denominator, denominator);
+  }
+  static constexpr uint8_t fixedShift(const uint64_t numerator, const uint32_t denominator) {
+    return (numerator == 0 || denominator == 0)
+               ? 0
+               : fixedShift(numerator / denominator, numerator % denominator, denominator, 0);
+  }
+  static constexpr uint64_t fixedMultiplier(const uint64_t numerator, const uint32_t denominator) {
+    return (numerator == 0 || denominator == 0)
+               ? 0
+               : fixedRoundUp(numerator / denominator, numerator % denominator, denominator);
+  }
+  template <uint64_t MULTIPLIER, uint8_t SHIFT>
+  static int64_t scale(const int32_t raw) {
+    /*! @brief Returns raw * MULTIPLIER / 2^SHIFT truncated towards zero, see "fixedScale()" */
+    static_assert(MULTIPLIER == 0 || SHIFT >= 32, "conversion factor too large");  // 0 has no shift
+    if (MULTIPLIER == 0) return 0;
+    uint32_t magnitude = raw < 0 ? (uint32_t)-raw : (uint32_t)raw;
+    uint64_t low       = (uint64_t)magnitude * (uint32_t)MULTIPLIER;
+    uint64_t high      = (uint64_t)magnitude * (uint32_t)(MULTIPLIER >> 32);
+    int64_t  result    = (int64_t)((high + (low >> 32)) >> (SHIFT - 32));
+    return raw < 0 ? -result : result;
+  }
+  static int64_t toMilliVolts(const int32_t raw) {
+    return scale<fixedMultiplier(busLSB(), 100), fixedShift(busLSB(), 100)>(raw);
+  }
+  static int64_t toMicroVolts(const int32_t raw) {
+    return scale<fixedMultiplier(shuntLSB(), 10), fixedShift(shuntLSB(), 10)>(raw);
+  }
+  static int64_t toMicroAmps(const int32_t raw) {  // INA3221: from the raw shunt value
+    return isINA3221() ? scale<fixedMultiplier((uint64_t)shuntLSB() * 100000, MICRO_OHM_R),
+                               fixedShift((uint64_t)shuntLSB() * 100000, MICRO_OHM_R)>(raw)
+                       : scale<fixedMultiplier(currentLSB(), 1000),
+                               fixedShift(currentLSB(), 1000)>(raw);
+  }
+  static int64_t toMicroWatts(const int32_t raw) {  // INA3221: from the raw shunt * bus product
+    return isINA3221() ? scale<fixedMultiplier((uint32_t)shuntLSB() * busLSB(), MICRO_OHM_R),
+                               fixedShift((uint32_t)shuntLSB() * busLSB(), MICRO_OHM_R)>(raw)
+                       : scale<fixedMultiplier(powerLSB(), 1000),
+                               fixedShift(powerLSB(), 1000)>(raw);
+  }
+  bool triggered() const { return !bitRead(State::mode, 2); }
+  void retrigger() { writeWord(INA_CONFIGURATION_REGISTER, State::config); }  // Start conversion
+  int16_t readWord(const uint8_t addr) {
+    /*! @brief     Reads a register, the pointer write and settle delay are skipped if the device
+                   already points to it
+        @param[in] addr register to read
+        @return    register value */
+    if (State::pointer != addr) {
+      Wire.beginTransmission(ADDRESS);  // Address the I2C device
+      Wire.write(addr);                 // Send register address
+      State::pointer = Wire.endTransmission() == 0 ? addr : (uint8_t)UINT8_MAX;  // Close
+      delayMicroseconds(I2C_DELAY);     // delay required for sync
+    }                                   // if-then pointer changed
+    Wire.requestFrom(ADDRESS, (uint8_t)2);  // Request 2 consecutive bytes
+    uint16_t msb = Wire.read();             // MSB is sent first
+    return (msb << 8) | Wire.read();
+  }  // of method readWord()
+  void writeWord(const uint8_t addr, const uint16_t data) {
+    /*! @brief     Writes a register, leaving the device's pointer at it
+        @param[in] addr register to write
+        @param[in] data value to write */
+    Wire.beginTransmission(ADDRESS);   // Address the I2C device
+    Wire.write(addr);                  // Send register address to write
+    Wire.write((uint8_t)(data >> 8));  // Write the first (MSB) byte
+    Wire.write((uint8_t)data);         // and then the second byte
+    State::pointer = Wire.endTransmission() == 0 ? addr : (uint8_t)UINT8_MAX;  // Close
+    delayMicroseconds(I2C_DELAY);      // delay required for sync
+  }  // of method writeWord()
+  typedef INA_DeviceState<ADDRESS> State;  ///< Shared by all objects for the same address
+};                                         // of INA_Device definition
+#endif